@@ -13,10 +13,311 @@
  * Data: Setembro 2025
  */
 
+#define _GNU_SOURCE      // Fixação de threads em processadores (pthread_attr_setaffinity_np)
+
 #include <stdio.h>   // Biblioteca para entrada e saída de dados
 #include <stdlib.h>  // Biblioteca para alocação dinâmica e números aleatórios
 #include <string.h>  // Biblioteca para manipulação de strings
 #include <time.h>    // Biblioteca para semente de aleatoriedade
+#include <stdint.h>  // Biblioteca para inteiros de largura fixa (conjuntos de bits)
+#include <pthread.h> // Biblioteca para varreduras paralelas do mapa
+#include <unistd.h>  // Biblioteca para consultar o número de processadores
+#include <stdatomic.h> // Biblioteca para o anel de eventos sem travas
+#include <fcntl.h>   // Biblioteca para criar o arquivo de mapa gerado
+#include <math.h>    // Biblioteca para a distribuição exponencial de tropas
+#include <sched.h>   // Biblioteca para conjuntos de processadores
+#include <sys/mman.h> // Biblioteca para mapear vetores em páginas grandes
+#include <sys/wait.h> // Biblioteca para acompanhar os processos da fazenda
+#include <errno.h>   // Biblioteca para repetir leituras interrompidas
+
+/*
+ * Instrumentação dos pontos críticos (compilada só com -DWAR_INSTRUMENTACAO)
+ * 
+ * Cada thread acumula seus próprios contadores e histogramas de ciclos, sem
+ * travas no caminho medido; o relatório pedido com --stats soma todas as
+ * threads na saída do programa. Sem a macro, MEDIR_ESCOPO e CONTAR não
+ * geram código algum.
+ */
+#ifdef WAR_INSTRUMENTACAO
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Trechos de código medidos
+enum PontoMedicao {
+    PONTO_ATACAR,
+    PONTO_VALIDAR,
+    PONTO_MISSAO,
+    PONTO_EXIBIR,
+    PONTO_ENTRADA,
+    TOTAL_PONTOS
+};
+
+// Eventos contados
+enum EventoContado {
+    REJEICAO_MESMO_TERRITORIO,
+    REJEICAO_ALIADOS,
+    REJEICAO_TROPAS,
+    REJEICAO_FRONTEIRA,
+    TOTAL_EVENTOS
+};
+
+// Histograma log-linear: 4 faixas para cada potência de 2 de ciclos
+#define FAIXAS_HISTOGRAMA 256
+
+/*
+ * Definição da estrutura ContadoresThread
+ * 
+ * Medições acumuladas por uma thread:
+ * - chamadas/ciclos/maximo: totais por ponto medido
+ * - histograma: distribuição de ciclos por ponto, para os percentis
+ * - eventos: contagem de eventos (motivos de rejeição de ataque)
+ */
+struct ContadoresThread {
+    uint64_t chamadas[TOTAL_PONTOS];
+    uint64_t ciclos[TOTAL_PONTOS];
+    uint64_t maximo[TOTAL_PONTOS];
+    uint64_t histograma[TOTAL_PONTOS][FAIXAS_HISTOGRAMA];
+    uint64_t eventos[TOTAL_EVENTOS];
+    struct ContadoresThread* proximo;
+};
+
+// Medição em andamento (encerrada automaticamente ao sair do escopo)
+struct Medicao {
+    int ponto;
+    uint64_t inicio;
+};
+
+struct ContadoresThread* listaContadores = NULL;  // Contadores de todas as threads
+pthread_mutex_t travaContadores = PTHREAD_MUTEX_INITIALIZER;
+_Thread_local struct ContadoresThread* contadoresThread = NULL;
+
+/*
+ * Função para ler o contador de ciclos do processador
+ */
+static inline uint64_t lerCiclos(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (uint64_t)agora.tv_sec * 1000000000ULL + (uint64_t)agora.tv_nsec;
+#endif
+}
+
+/*
+ * Função para obter os contadores da thread atual, criando-os na primeira vez
+ * 
+ * Retorna:
+ * - Ponteiro para os contadores (NULL se faltou memória)
+ */
+static struct ContadoresThread* obterContadoresThread(void) {
+    if (contadoresThread == NULL) {
+        contadoresThread = (struct ContadoresThread*)calloc(1, sizeof(struct ContadoresThread));
+        if (contadoresThread != NULL) {
+            pthread_mutex_lock(&travaContadores);
+            contadoresThread->proximo = listaContadores;
+            listaContadores = contadoresThread;
+            pthread_mutex_unlock(&travaContadores);
+        }
+    }
+    return contadoresThread;
+}
+
+/*
+ * Função para calcular a faixa do histograma de uma duração em ciclos
+ */
+static inline int faixaHistograma(uint64_t ciclos) {
+    if (ciclos < 4) {
+        return (int)ciclos;
+    }
+    int bitMaisAlto = 63 - __builtin_clzll(ciclos);
+    return (bitMaisAlto << 2) | (int)((ciclos >> (bitMaisAlto - 2)) & 3);
+}
+
+/*
+ * Função para obter o menor valor em ciclos de uma faixa do histograma
+ */
+static uint64_t inicioFaixa(int faixa) {
+    if (faixa < 4) {
+        return (uint64_t)faixa;
+    }
+    return (uint64_t)(4 | (faixa & 3)) << ((faixa >> 2) - 2);
+}
+
+/*
+ * Função chamada ao fim de cada escopo medido com MEDIR_ESCOPO
+ */
+static inline void finalizarMedicao(struct Medicao* medicao) {
+    uint64_t ciclos = lerCiclos() - medicao->inicio;
+    struct ContadoresThread* contadores = obterContadoresThread();
+    
+    if (contadores != NULL) {
+        contadores->chamadas[medicao->ponto]++;
+        contadores->ciclos[medicao->ponto] += ciclos;
+        if (ciclos > contadores->maximo[medicao->ponto]) {
+            contadores->maximo[medicao->ponto] = ciclos;
+        }
+        contadores->histograma[medicao->ponto][faixaHistograma(ciclos)]++;
+    }
+}
+
+// Mede o tempo do ponto de entrada até a saída do escopo (qualquer return)
+#define MEDIR_ESCOPO(ponto) \
+    struct Medicao medicao_##ponto __attribute__((cleanup(finalizarMedicao))) = { (ponto), lerCiclos() }
+
+// Incrementa um contador de eventos da thread atual
+#define CONTAR(evento) \
+    do { \
+        struct ContadoresThread* contadores_ = obterContadoresThread(); \
+        if (contadores_ != NULL) contadores_->eventos[evento]++; \
+    } while (0)
+
+#else
+
+#define MEDIR_ESCOPO(ponto) ((void)0)
+#define CONTAR(evento) ((void)0)
+
+#endif
+
+// Formato do relatório de instrumentação: 0 = nenhum, 1 = texto, 2 = JSON
+int formatoRelatorio = 0;
+
+#ifdef WAR_INSTRUMENTACAO
+/*
+ * Função para calcular um percentil a partir de um histograma
+ * 
+ * Retorna:
+ * - Início da faixa que contém o percentil (em ciclos)
+ */
+uint64_t percentilHistograma(const uint64_t* histograma, uint64_t total, double percentil) {
+    uint64_t alvo = (uint64_t)(total * percentil);
+    uint64_t acumulado = 0;
+    
+    for (int f = 0; f < FAIXAS_HISTOGRAMA; f++) {
+        acumulado += histograma[f];
+        if (acumulado > alvo) {
+            return inicioFaixa(f);
+        }
+    }
+    return 0;
+}
+#endif
+
+/*
+ * Função para emitir o relatório de instrumentação (registrada com atexit)
+ * 
+ * Soma os contadores de todas as threads e escreve em stderr, em texto ou
+ * JSON conforme a opção --stats.
+ */
+void emitirRelatorioInstrumentacao(void) {
+#ifdef WAR_INSTRUMENTACAO
+    static const char* nomesPontos[TOTAL_PONTOS] = { "atacar", "validarAtaque", "verificarMissao", "exibirTerritorios", "entrada" };
+    static const int pontosLogica[] = { PONTO_ATACAR, PONTO_VALIDAR, PONTO_MISSAO };
+    struct ContadoresThread soma;
+    
+    memset(&soma, 0, sizeof(soma));
+    pthread_mutex_lock(&travaContadores);
+    for (struct ContadoresThread* c = listaContadores; c != NULL; c = c->proximo) {
+        for (int p = 0; p < TOTAL_PONTOS; p++) {
+            soma.chamadas[p] += c->chamadas[p];
+            soma.ciclos[p] += c->ciclos[p];
+            if (c->maximo[p] > soma.maximo[p]) soma.maximo[p] = c->maximo[p];
+            for (int f = 0; f < FAIXAS_HISTOGRAMA; f++) {
+                soma.histograma[p][f] += c->histograma[p][f];
+            }
+        }
+        for (int e = 0; e < TOTAL_EVENTOS; e++) {
+            soma.eventos[e] += c->eventos[e];
+        }
+    }
+    pthread_mutex_unlock(&travaContadores);
+    
+    uint64_t rejeicoes = soma.eventos[REJEICAO_MESMO_TERRITORIO] + soma.eventos[REJEICAO_ALIADOS] +
+                         soma.eventos[REJEICAO_TROPAS] + soma.eventos[REJEICAO_FRONTEIRA];
+    double taxaRejeicao = soma.chamadas[PONTO_VALIDAR] ?
+                          (double)rejeicoes / soma.chamadas[PONTO_VALIDAR] : 0.0;
+    uint64_t ciclosLogica = 0;
+    for (size_t i = 0; i < sizeof(pontosLogica) / sizeof(pontosLogica[0]); i++) {
+        ciclosLogica += soma.ciclos[pontosLogica[i]];
+    }
+    uint64_t ciclosExibicao = soma.ciclos[PONTO_EXIBIR];
+    uint64_t ciclosEntrada = soma.ciclos[PONTO_ENTRADA];
+    
+    if (formatoRelatorio == 2) {
+        fprintf(stderr, "{\"pontos\": {");
+        for (int p = 0; p < TOTAL_PONTOS; p++) {
+            uint64_t n = soma.chamadas[p];
+            fprintf(stderr, "%s\"%s\": {\"chamadas\": %llu, \"ciclos\": %llu, \"p50\": %llu, "
+                    "\"p90\": %llu, \"p99\": %llu, \"max\": %llu}",
+                    p ? ", " : "", nomesPontos[p], (unsigned long long)n,
+                    (unsigned long long)soma.ciclos[p],
+                    (unsigned long long)percentilHistograma(soma.histograma[p], n, 0.50),
+                    (unsigned long long)percentilHistograma(soma.histograma[p], n, 0.90),
+                    (unsigned long long)percentilHistograma(soma.histograma[p], n, 0.99),
+                    (unsigned long long)soma.maximo[p]);
+        }
+        fprintf(stderr, "}, \"rejeicoes\": {\"mesmo_territorio\": %llu, \"aliados\": %llu, "
+                "\"tropas_insuficientes\": %llu, \"sem_fronteira\": %llu, \"taxa\": %.4f}, "
+                "\"ciclos\": {\"logica\": %llu, \"exibicao\": %llu, \"entrada\": %llu}}\n",
+                (unsigned long long)soma.eventos[REJEICAO_MESMO_TERRITORIO],
+                (unsigned long long)soma.eventos[REJEICAO_ALIADOS],
+                (unsigned long long)soma.eventos[REJEICAO_TROPAS],
+                (unsigned long long)soma.eventos[REJEICAO_FRONTEIRA], taxaRejeicao,
+                (unsigned long long)ciclosLogica, (unsigned long long)ciclosExibicao,
+                (unsigned long long)ciclosEntrada);
+        return;
+    }
+    
+    fprintf(stderr, "\n=================================================\n");
+    fprintf(stderr, "           RELATÓRIO DE INSTRUMENTAÇÃO\n");
+    fprintf(stderr, "=================================================\n");
+    fprintf(stderr, "%-18s %10s %14s %10s %10s %10s %12s\n",
+            "Ponto", "Chamadas", "Ciclos", "p50", "p90", "p99", "Máximo");
+    for (int p = 0; p < TOTAL_PONTOS; p++) {
+        uint64_t n = soma.chamadas[p];
+        fprintf(stderr, "%-18s %10llu %14llu %10llu %10llu %10llu %12llu\n", nomesPontos[p],
+                (unsigned long long)n, (unsigned long long)soma.ciclos[p],
+                (unsigned long long)percentilHistograma(soma.histograma[p], n, 0.50),
+                (unsigned long long)percentilHistograma(soma.histograma[p], n, 0.90),
+                (unsigned long long)percentilHistograma(soma.histograma[p], n, 0.99),
+                (unsigned long long)soma.maximo[p]);
+    }
+    
+    fprintf(stderr, "-------------------------------------------------\n");
+    fprintf(stderr, "Ataques rejeitados: %llu de %llu (%.1f%%)\n", (unsigned long long)rejeicoes,
+            (unsigned long long)soma.chamadas[PONTO_VALIDAR], 100.0 * taxaRejeicao);
+    fprintf(stderr, "    Mesmo território: %llu | Aliados: %llu | Tropas insuficientes: %llu | "
+            "Sem fronteira: %llu\n",
+            (unsigned long long)soma.eventos[REJEICAO_MESMO_TERRITORIO],
+            (unsigned long long)soma.eventos[REJEICAO_ALIADOS],
+            (unsigned long long)soma.eventos[REJEICAO_TROPAS],
+            (unsigned long long)soma.eventos[REJEICAO_FRONTEIRA]);
+    
+    uint64_t ciclosTotais = ciclosLogica + ciclosExibicao + ciclosEntrada;
+    if (ciclosTotais > 0) {
+        fprintf(stderr, "Divisão do tempo: lógica %.1f%% | exibição %.1f%% | entrada %.1f%%\n",
+                100.0 * ciclosLogica / ciclosTotais, 100.0 * ciclosExibicao / ciclosTotais,
+                100.0 * ciclosEntrada / ciclosTotais);
+    }
+    fprintf(stderr, "=================================================\n");
+#endif
+}
+
+/*
+ * Função para registrar o relatório de instrumentação, se pedido
+ */
+void ativarRelatorioInstrumentacao(void) {
+    if (formatoRelatorio == 0) {
+        return;
+    }
+#ifdef WAR_INSTRUMENTACAO
+    atexit(emitirRelatorioInstrumentacao);
+#else
+    printf("Aviso: --stats ignorado; compile com -DWAR_INSTRUMENTACAO para medir.\n");
+#endif
+}
 
 /*
  * Definição da estrutura Territorio
@@ -48,10 +349,274 @@ char* missoesPredefinidas[] = {
 
 #define TOTAL_MISSOES 6
 
+// Quantidade de alvos exibidos pelo comando de sugestão de ataque
+#define SUGESTOES_ATAQUE 3
+
+// Máximo de territórios listados por exibirTerritorios
+#define LIMITE_EXIBICAO 200
+
 // Variáveis globais para o sistema de missões
 char* missaoJogador = NULL;  // Missão do jogador (alocada dinamicamente)
 char corJogador[10];         // Cor do jogador atual
 
+/*
+ * Alocação dos vetores por território em mapas muito grandes
+ * 
+ * Com calloc, um vetor de milhões de territórios fica em páginas de 4 KiB
+ * (muitas faltas de TLB nas varreduras) e é tocado pela primeira vez por uma
+ * única thread, que coloca todas as páginas no mesmo nó NUMA. Nos modos de
+ * páginas grandes o vetor é mapeado com mmap em páginas de 2 MiB e o
+ * primeiro toque é feito em paralelo, com a mesma divisão em trechos e as
+ * mesmas threads fixadas em processadores que as varreduras usam: cada
+ * trecho fica no nó de quem vai lê-lo.
+ */
+#define ALOCACAO_PADRAO 0        // calloc
+#define ALOCACAO_TRANSPARENTE 1  // mmap + madvise(MADV_HUGEPAGE)
+#define ALOCACAO_EXPLICITA 2     // mmap com MAP_HUGETLB (reserva em /proc/sys/vm/nr_hugepages)
+
+// Modo de alocação (--paginas-grandes)
+int modoAlocacao = ALOCACAO_PADRAO;
+
+// Tamanho de página grande assumido para arredondar os mapeamentos
+#define TAMANHO_PAGINA_GRANDE (2UL * 1024 * 1024)
+
+// Trechos menores que isto não compensam uma thread própria
+#define TERRITORIOS_POR_THREAD 65536
+
+// Número máximo de threads usadas pelas varreduras paralelas
+#define MAX_THREADS 64
+
+// Máximo de vetores mapeados ao mesmo tempo (o resto usa calloc)
+#define MAX_BLOCOS_MAPEADOS 32
+
+// Vetores alocados com mmap, para que liberarVetorGrande saiba o tamanho
+struct BlocoMapeado {
+    void* inicio;
+    size_t tamanho;
+};
+struct BlocoMapeado blocosMapeados[MAX_BLOCOS_MAPEADOS];
+pthread_mutex_t travaBlocosMapeados = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Função para decidir em quantos trechos uma varredura paralela é dividida
+ * 
+ * Parâmetros:
+ * - tamanho: número de territórios varridos
+ * 
+ * Retorna:
+ * - Número de trechos (1 = varredura na própria thread)
+ * 
+ * O primeiro toque dos vetores grandes usa a mesma divisão, para que cada
+ * trecho seja lido pela mesma thread que o tocou.
+ */
+int trechosDeVarredura(int tamanho) {
+    int numThreads = tamanho / TERRITORIOS_POR_THREAD;
+    long processadores = sysconf(_SC_NPROCESSORS_ONLN);
+    
+    if (numThreads > processadores) numThreads = (int)processadores;
+    if (numThreads > MAX_THREADS) numThreads = MAX_THREADS;
+    return numThreads < 1 ? 1 : numThreads;
+}
+
+/*
+ * Função para criar a thread de um trecho de varredura
+ * 
+ * Parâmetros:
+ * - thread: recebe o identificador da thread
+ * - trecho: índice do trecho (define o processador)
+ * - funcao, argumento: como em pthread_create
+ * 
+ * Retorna:
+ * - 0 em caso de sucesso (como pthread_create)
+ * 
+ * Fora do modo padrão, a thread do trecho t fica fixada no processador t,
+ * o mesmo em todas as varreduras e no primeiro toque. O trecho 0 é sempre
+ * da thread chamadora (ver fixarChamadoraNoTrecho).
+ */
+int criarThreadDoTrecho(pthread_t* thread, int trecho, void* (*funcao)(void*), void* argumento) {
+    if (modoAlocacao == ALOCACAO_PADRAO) {
+        return pthread_create(thread, NULL, funcao, argumento);
+    }
+    
+    pthread_attr_t atributos;
+    cpu_set_t processadores;
+    long total = sysconf(_SC_NPROCESSORS_ONLN);
+    
+    CPU_ZERO(&processadores);
+    CPU_SET((int)(trecho % (total > 0 ? total : 1)), &processadores);
+    pthread_attr_init(&atributos);
+    pthread_attr_setaffinity_np(&atributos, sizeof(processadores), &processadores);
+    int erro = pthread_create(thread, &atributos, funcao, argumento);
+    pthread_attr_destroy(&atributos);
+    return erro;
+}
+
+/*
+ * Função para fixar a thread chamadora no processador de um trecho
+ * 
+ * Parâmetros:
+ * - trecho: índice do trecho que a chamadora vai varrer
+ * - anterior: recebe a afinidade atual, para restaurarAfinidade
+ * 
+ * Retorna:
+ * - 1 se a afinidade foi trocada (chamar restaurarAfinidade depois)
+ * - 0 no modo padrão ou se a troca falhou
+ * 
+ * A afinidade dura só a varredura: threads criadas depois pela chamadora
+ * herdariam o processador fixo.
+ */
+int fixarChamadoraNoTrecho(int trecho, cpu_set_t* anterior) {
+    if (modoAlocacao == ALOCACAO_PADRAO) {
+        return 0;
+    }
+    
+    cpu_set_t processadores;
+    long total = sysconf(_SC_NPROCESSORS_ONLN);
+    
+    if (pthread_getaffinity_np(pthread_self(), sizeof(*anterior), anterior) != 0) {
+        return 0;
+    }
+    CPU_ZERO(&processadores);
+    CPU_SET((int)(trecho % (total > 0 ? total : 1)), &processadores);
+    return pthread_setaffinity_np(pthread_self(), sizeof(processadores), &processadores) == 0;
+}
+
+/*
+ * Função para devolver à thread chamadora a afinidade anterior
+ */
+void restaurarAfinidade(const cpu_set_t* anterior) {
+    pthread_setaffinity_np(pthread_self(), sizeof(*anterior), anterior);
+}
+
+/*
+ * Definição da estrutura TrechoPrimeiroToque
+ * 
+ * Faixa de bytes de um vetor recém-mapeado tocada por uma thread.
+ */
+struct TrechoPrimeiroToque {
+    char* inicio;
+    size_t tamanho;
+};
+
+/*
+ * Função executada por cada thread do primeiro toque
+ */
+void* tocarTrecho(void* argumento) {
+    struct TrechoPrimeiroToque* trecho = (struct TrechoPrimeiroToque*)argumento;
+    memset(trecho->inicio, 0, trecho->tamanho);
+    return NULL;
+}
+
+/*
+ * Função para alocar um vetor por território, zerado
+ * 
+ * Parâmetros:
+ * - quantidade: número de itens (territórios)
+ * - tamanhoItem: bytes por item
+ * 
+ * Retorna:
+ * - Ponteiro para o vetor (liberar com liberarVetorGrande)
+ * - NULL em caso de erro
+ * 
+ * No modo padrão, ou para vetores menores que uma página grande, equivale
+ * a calloc. Se MAP_HUGETLB falhar por falta de páginas reservadas, cai para
+ * páginas grandes transparentes.
+ */
+void* alocarVetorGrande(size_t quantidade, size_t tamanhoItem) {
+    size_t bytes = quantidade * tamanhoItem;
+    
+    if (modoAlocacao == ALOCACAO_PADRAO || bytes < TAMANHO_PAGINA_GRANDE) {
+        return calloc(quantidade, tamanhoItem);
+    }
+    
+    size_t tamanho = (bytes + TAMANHO_PAGINA_GRANDE - 1) & ~(TAMANHO_PAGINA_GRANDE - 1);
+    void* vetor = MAP_FAILED;
+    
+#ifdef MAP_HUGETLB
+    if (modoAlocacao == ALOCACAO_EXPLICITA) {
+        vetor = mmap(NULL, tamanho, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        static int avisado = 0;
+        if (vetor == MAP_FAILED && !avisado) {
+            printf("Aviso: sem páginas grandes reservadas para %zu bytes; "
+                   "usando páginas grandes transparentes.\n", tamanho);
+            avisado = 1;
+        }
+    }
+#endif
+    if (vetor == MAP_FAILED) {
+        vetor = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (vetor == MAP_FAILED) {
+            return NULL;
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(vetor, tamanho, MADV_HUGEPAGE);  // Só um pedido; o kernel pode recusar
+#endif
+    }
+    
+    // Registra o mapeamento; sem espaço na tabela, volta para calloc
+    int registrado = 0;
+    pthread_mutex_lock(&travaBlocosMapeados);
+    for (int b = 0; b < MAX_BLOCOS_MAPEADOS && !registrado; b++) {
+        if (blocosMapeados[b].inicio == NULL) {
+            blocosMapeados[b].inicio = vetor;
+            blocosMapeados[b].tamanho = tamanho;
+            registrado = 1;
+        }
+    }
+    pthread_mutex_unlock(&travaBlocosMapeados);
+    if (!registrado) {
+        munmap(vetor, tamanho);
+        return calloc(quantidade, tamanhoItem);
+    }
+    
+    // Primeiro toque em paralelo, trecho a trecho como nas varreduras
+    int numTrechos = trechosDeVarredura((int)quantidade);
+    struct TrechoPrimeiroToque trechos[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    int criadas[MAX_THREADS];
+    
+    for (int t = 0; t < numTrechos; t++) {
+        size_t inicio = quantidade * t / numTrechos * tamanhoItem;
+        size_t fim = quantidade * (t + 1) / numTrechos * tamanhoItem;
+        trechos[t].inicio = (char*)vetor + inicio;
+        trechos[t].tamanho = fim - inicio;
+        criadas[t] = (t > 0 && criarThreadDoTrecho(&threads[t], t, tocarTrecho, &trechos[t]) == 0);
+    }
+    cpu_set_t afinidade;
+    int fixada = fixarChamadoraNoTrecho(0, &afinidade);
+    for (int t = 0; t < numTrechos; t++) {
+        if (!criadas[t]) tocarTrecho(&trechos[t]);
+    }
+    if (fixada) restaurarAfinidade(&afinidade);
+    for (int t = 1; t < numTrechos; t++) {
+        if (criadas[t]) pthread_join(threads[t], NULL);
+    }
+    
+    return vetor;
+}
+
+/*
+ * Função para liberar um vetor alocado com alocarVetorGrande
+ */
+void liberarVetorGrande(void* vetor) {
+    if (vetor == NULL) {
+        return;
+    }
+    
+    pthread_mutex_lock(&travaBlocosMapeados);
+    for (int b = 0; b < MAX_BLOCOS_MAPEADOS; b++) {
+        if (blocosMapeados[b].inicio == vetor) {
+            munmap(vetor, blocosMapeados[b].tamanho);
+            blocosMapeados[b].inicio = NULL;
+            pthread_mutex_unlock(&travaBlocosMapeados);
+            return;
+        }
+    }
+    pthread_mutex_unlock(&travaBlocosMapeados);
+    free(vetor);
+}
+
 /*
  * Função para alocar memória dinamicamente para os territórios
  * 
@@ -63,7 +628,7 @@ char corJogador[10];         // Cor do jogador atual
  * - NULL em caso de erro na alocação
  */
 struct Territorio* alocarTerritorios(int quantidade) {
-    struct Territorio* mapa = (struct Territorio*)calloc(quantidade, sizeof(struct Territorio));
+    struct Territorio* mapa = (struct Territorio*)alocarVetorGrande(quantidade, sizeof(struct Territorio));
     
     if (mapa == NULL) {
         printf("Erro: Não foi possível alocar memória para os territórios!\n");
@@ -75,381 +640,6371 @@ struct Territorio* alocarTerritorios(int quantidade) {
 }
 
 /*
- * Função para atribuir uma missão aleatória ao jogador
+ * Registro de cores dos exércitos
  * 
- * Parâmetros:
- * - destino: ponteiro para onde a missão será copiada (passagem por referência)
- * - missoes: vetor de strings com as missões disponíveis
- * - totalMissoes: número total de missões disponíveis
+ * Cada cor distinta encontrada no mapa recebe um identificador inteiro
+ * pequeno (0 a MAX_CORES - 1), usado pelos índices incrementais no lugar
+ * de comparações de strings.
  */
-void atribuirMissao(char* destino, char* missoes[], int totalMissoes) {
-    int indiceMissao = rand() % totalMissoes;
-    strcpy(destino, missoes[indiceMissao]);
-}
+#define MAX_CORES 64
+
+char coresRegistradas[MAX_CORES][10];  // Nome de cada cor registrada
+int totalCores = 0;                    // Quantidade de cores registradas
 
 /*
- * Função para exibir a missão do jogador
+ * Função para buscar o identificador de uma cor já registrada
  * 
  * Parâmetros:
- * - missao: string com a missão do jogador (passada por valor)
+ * - cor: string com a cor do exército
+ * 
+ * Retorna:
+ * - Identificador da cor
+ * - -1 se a cor nunca foi registrada
  */
-void exibirMissao(char* missao) {
-    printf("\n=== SUA MISSÃO ESTRATÉGICA ===\n");
-    printf("Objetivo: %s\n", missao);
-    printf("==============================\n");
+int buscarIdCor(const char* cor) {
+    for (int c = 0; c < totalCores; c++) {
+        if (strcmp(coresRegistradas[c], cor) == 0) {
+            return c;
+        }
+    }
+    return -1;
 }
 
 /*
- * Função para verificar se a missão foi cumprida
+ * Função para obter o identificador de uma cor, registrando-a se for nova
  * 
  * Parâmetros:
- * - missao: string com a missão a ser verificada (passada por valor)
- * - mapa: ponteiro para o vetor de territórios
- * - tamanho: número de territórios no mapa
+ * - cor: string com a cor do exército
  * 
  * Retorna:
- * - 1 se a missão foi cumprida
- * - 0 se a missão ainda não foi cumprida
+ * - Identificador da cor (0 a MAX_CORES - 1)
+ * - -1 se o limite de cores foi atingido
  */
-int verificarMissao(char* missao, struct Territorio* mapa, int tamanho) {
-    // Missão 1: "Conquistar 3 territórios consecutivos"
-    if (strcmp(missao, "Conquistar 3 territórios consecutivos") == 0) {
-        int consecutivos = 0;
-        int maxConsecutivos = 0;
-        
-        for (int i = 0; i < tamanho; i++) {
-            if (strcmp(mapa[i].cor, corJogador) == 0) {
-                consecutivos++;
-                if (consecutivos > maxConsecutivos) {
-                    maxConsecutivos = consecutivos;
-                }
-            } else {
-                consecutivos = 0;
-            }
-        }
-        return maxConsecutivos >= 3;
-    }
-    
-    // Missão 2: "Eliminar todas as tropas vermelhas do mapa"
-    if (strcmp(missao, "Eliminar todas as tropas vermelhas do mapa") == 0) {
-        for (int i = 0; i < tamanho; i++) {
-            if (strcmp(mapa[i].cor, "Vermelho") == 0 || strcmp(mapa[i].cor, "vermelho") == 0) {
-                return 0; // Ainda existem territórios vermelhos
-            }
-        }
-        return 1; // Não há mais territórios vermelhos
+int obterIdCor(const char* cor) {
+    int id = buscarIdCor(cor);
+    if (id != -1) {
+        return id;
     }
     
-    // Missão 3: "Controlar pelo menos 4 territórios"
-    if (strcmp(missao, "Controlar pelo menos 4 territórios") == 0) {
-        int territoriosControlados = 0;
-        
-        for (int i = 0; i < tamanho; i++) {
-            if (strcmp(mapa[i].cor, corJogador) == 0) {
-                territoriosControlados++;
-            }
-        }
-        return territoriosControlados >= 4;
+    if (totalCores == MAX_CORES) {
+        return -1;
     }
     
-    // Missão 4: "Ter mais de 2000 tropas no total"
-    if (strcmp(missao, "Ter mais de 2000 tropas no total") == 0) {
-        int totalTropas = 0;
-        
-        for (int i = 0; i < tamanho; i++) {
-            if (strcmp(mapa[i].cor, corJogador) == 0) {
-                totalTropas += mapa[i].tropas;
-            }
-        }
-        return totalTropas > 2000;
+    snprintf(coresRegistradas[totalCores], sizeof(coresRegistradas[totalCores]), "%s", cor);
+    return totalCores++;
+}
+
+/*
+ * Definição da estrutura HeapTerritorios
+ * 
+ * Heap binário indexado de territórios de um mesmo dono:
+ * - itens: índices dos territórios no mapa, organizados como heap
+ * - tamanho: número de territórios no heap
+ * - capacidade: espaço alocado em itens
+ */
+struct HeapTerritorios {
+    int* itens;
+    int tamanho;
+    int capacidade;
+};
+
+/*
+ * Definição da estrutura IndiceAlvos
+ * 
+ * Índice incremental de territórios por dono, atualizado a cada ataque:
+ * - maisFracos: um heap mínimo por cor, ordenado por tropas (alvos)
+ * - maisFortes: um heap máximo por cor, ordenado por tropas (atacantes)
+ * - corDe: identificador da cor atual de cada território
+ * - corOriginal: cor de cada território quando o índice foi construído
+ * - posicaoFracos/posicaoFortes: posição de cada território no seu heap
+ * - posse: um conjunto de bits por cor (bit i ligado = território i é da cor)
+ */
+struct IndiceAlvos {
+    struct Territorio* mapa;   // Mapa indexado
+    int tamanho;               // Número de territórios do mapa
+    int ativo;                 // 1 se o índice está construído e válido
+    unsigned char* corDe;      // Cor atual de cada território
+    unsigned char* corOriginal; // Cor inicial de cada território
+    int* posicaoFracos;        // Posição no heap mínimo do dono
+    int* posicaoFortes;        // Posição no heap máximo do dono
+    struct HeapTerritorios maisFracos[MAX_CORES];
+    struct HeapTerritorios maisFortes[MAX_CORES];
+    int palavras;              // Palavras de 64 bits por conjunto de posse
+    uint64_t* posse[MAX_CORES];
+};
+
+// Índice global de alvos do mapa em jogo
+struct IndiceAlvos indiceAlvos;
+
+/*
+ * Territórios alterados desde a última consulta à análise de viabilidade
+ * 
+ * atualizarIndiceAlvos só anota o território e o dono anterior; a análise
+ * decide quais cores refazer quando é consultada. Com o registro cheio ou
+ * um índice reconstruído, todas as cores são refeitas.
+ */
+#define MAX_ALTERACOES_PENDENTES 4096
+
+struct AlteracoesPendentes {
+    int total;
+    int transbordou;  // 1 = refazer todas as cores
+    int indice[MAX_ALTERACOES_PENDENTES];
+    unsigned char corAntiga[MAX_ALTERACOES_PENDENTES];
+};
+
+// Alterações ainda não vistas pela análise de viabilidade
+struct AlteracoesPendentes alteracoesPendentes;
+
+/*
+ * Função para comparar dois territórios dentro de um heap
+ * 
+ * Parâmetros:
+ * - a, b: índices dos territórios
+ * - minimo: 1 para heap mínimo (menos tropas primeiro), 0 para heap máximo
+ * 
+ * Retorna:
+ * - 1 se 'a' deve ficar acima de 'b' no heap
+ * - 0 caso contrário
+ * 
+ * Empates são desfeitos pelo índice para que a ordem seja determinística.
+ */
+int precedeNoHeap(int a, int b, int minimo) {
+    int tropasA = indiceAlvos.mapa[a].tropas;
+    int tropasB = indiceAlvos.mapa[b].tropas;
+    
+    if (tropasA != tropasB) {
+        return minimo ? tropasA < tropasB : tropasA > tropasB;
+    }
+    return a < b;
+}
+
+/*
+ * Função para mover um item do heap em direção à raiz
+ * 
+ * Parâmetros:
+ * - heap: ponteiro para o heap
+ * - posicaoDe: vetor de posições dos territórios neste tipo de heap
+ * - pos: posição inicial do item
+ * - minimo: tipo do heap (ver precedeNoHeap)
+ */
+void heapSubir(struct HeapTerritorios* heap, int* posicaoDe, int pos, int minimo) {
+    int item = heap->itens[pos];
+    
+    while (pos > 0) {
+        int pai = (pos - 1) / 2;
+        if (!precedeNoHeap(item, heap->itens[pai], minimo)) {
+            break;
+        }
+        heap->itens[pos] = heap->itens[pai];
+        posicaoDe[heap->itens[pos]] = pos;
+        pos = pai;
+    }
+    
+    heap->itens[pos] = item;
+    posicaoDe[item] = pos;
+}
+
+/*
+ * Função para mover um item do heap em direção às folhas
+ * 
+ * Parâmetros: os mesmos de heapSubir
+ */
+void heapDescer(struct HeapTerritorios* heap, int* posicaoDe, int pos, int minimo) {
+    int item = heap->itens[pos];
+    
+    while (1) {
+        int filho = 2 * pos + 1;
+        if (filho >= heap->tamanho) {
+            break;
+        }
+        if (filho + 1 < heap->tamanho &&
+            precedeNoHeap(heap->itens[filho + 1], heap->itens[filho], minimo)) {
+            filho++;
+        }
+        if (!precedeNoHeap(heap->itens[filho], item, minimo)) {
+            break;
+        }
+        heap->itens[pos] = heap->itens[filho];
+        posicaoDe[heap->itens[pos]] = pos;
+        pos = filho;
+    }
+    
+    heap->itens[pos] = item;
+    posicaoDe[item] = pos;
+}
+
+/*
+ * Função para inserir um território no heap
+ * 
+ * Retorna:
+ * - 1 em caso de sucesso
+ * - 0 se não foi possível aumentar o heap
+ */
+int heapInserir(struct HeapTerritorios* heap, int* posicaoDe, int territorio, int minimo) {
+    if (heap->tamanho == heap->capacidade) {
+        int novaCapacidade = heap->capacidade ? heap->capacidade * 2 : 16;
+        int* novosItens = (int*)realloc(heap->itens, novaCapacidade * sizeof(int));
+        if (novosItens == NULL) {
+            return 0;
+        }
+        heap->itens = novosItens;
+        heap->capacidade = novaCapacidade;
+    }
+    
+    heap->itens[heap->tamanho] = territorio;
+    heapSubir(heap, posicaoDe, heap->tamanho++, minimo);
+    return 1;
+}
+
+/*
+ * Função para remover o item de uma posição qualquer do heap
+ */
+void heapRemover(struct HeapTerritorios* heap, int* posicaoDe, int pos, int minimo) {
+    int ultimo = heap->itens[--heap->tamanho];
+    
+    if (pos == heap->tamanho) {
+        return;
+    }
+    
+    heap->itens[pos] = ultimo;
+    posicaoDe[ultimo] = pos;
+    heapSubir(heap, posicaoDe, pos, minimo);
+    heapDescer(heap, posicaoDe, posicaoDe[ultimo], minimo);
+}
+
+/*
+ * Função para liberar a memória do índice de alvos
+ */
+void liberarIndiceAlvos() {
+    for (int c = 0; c < MAX_CORES; c++) {
+        free(indiceAlvos.maisFracos[c].itens);
+        free(indiceAlvos.maisFortes[c].itens);
+        free(indiceAlvos.posse[c]);
+    }
+    liberarVetorGrande(indiceAlvos.corDe);
+    liberarVetorGrande(indiceAlvos.corOriginal);
+    liberarVetorGrande(indiceAlvos.posicaoFracos);
+    liberarVetorGrande(indiceAlvos.posicaoFortes);
+    memset(&indiceAlvos, 0, sizeof(indiceAlvos));
+}
+
+/*
+ * Função para marcar a posse de um território no conjunto de bits de uma cor
+ * 
+ * Parâmetros:
+ * - cor: identificador da cor
+ * - territorio: índice do território
+ * - possui: 1 para ligar o bit, 0 para desligar
+ * 
+ * Retorna:
+ * - 1 em caso de sucesso
+ * - 0 se não foi possível alocar o conjunto da cor
+ */
+int marcarPosse(int cor, int territorio, int possui) {
+    if (indiceAlvos.posse[cor] == NULL) {
+        indiceAlvos.posse[cor] = (uint64_t*)calloc(indiceAlvos.palavras, sizeof(uint64_t));
+        if (indiceAlvos.posse[cor] == NULL) {
+            return 0;
+        }
+    }
+    
+    uint64_t bit = 1ULL << (territorio & 63);
+    if (possui) {
+        indiceAlvos.posse[cor][territorio >> 6] |= bit;
+    } else {
+        indiceAlvos.posse[cor][territorio >> 6] &= ~bit;
+    }
+    return 1;
+}
+
+/*
+ * Função para construir o índice de alvos a partir do mapa
+ * 
+ * Parâmetros:
+ * - mapa: ponteiro para o vetor de territórios
+ * - tamanho: número de territórios no mapa
+ * 
+ * Retorna:
+ * - 1 se o índice foi construído
+ * - 0 em caso de falta de memória ou cores demais (o jogo segue sem índice)
+ */
+int construirIndiceAlvos(struct Territorio* mapa, int tamanho) {
+    liberarIndiceAlvos();
+    
+    indiceAlvos.mapa = mapa;
+    indiceAlvos.tamanho = tamanho;
+    indiceAlvos.palavras = (tamanho + 63) / 64;
+    indiceAlvos.corDe = (unsigned char*)alocarVetorGrande(tamanho, sizeof(unsigned char));
+    indiceAlvos.corOriginal = (unsigned char*)alocarVetorGrande(tamanho, sizeof(unsigned char));
+    indiceAlvos.posicaoFracos = (int*)alocarVetorGrande(tamanho, sizeof(int));
+    indiceAlvos.posicaoFortes = (int*)alocarVetorGrande(tamanho, sizeof(int));
+    
+    if (indiceAlvos.corDe == NULL || indiceAlvos.corOriginal == NULL ||
+        indiceAlvos.posicaoFracos == NULL ||
+        indiceAlvos.posicaoFortes == NULL) {
+        liberarIndiceAlvos();
+        return 0;
+    }
+    
+    for (int i = 0; i < tamanho; i++) {
+        int cor = obterIdCor(mapa[i].cor);
+        if (cor < 0 ||
+            !heapInserir(&indiceAlvos.maisFracos[cor], indiceAlvos.posicaoFracos, i, 1) ||
+            !heapInserir(&indiceAlvos.maisFortes[cor], indiceAlvos.posicaoFortes, i, 0) ||
+            !marcarPosse(cor, i, 1)) {
+            liberarIndiceAlvos();
+            return 0;
+        }
+        indiceAlvos.corDe[i] = (unsigned char)cor;
+        indiceAlvos.corOriginal[i] = (unsigned char)cor;
+    }
+    
+    indiceAlvos.ativo = 1;
+    alteracoesPendentes.transbordou = 1;
+    return 1;
+}
+
+/*
+ * Função para obter a posição de um território no mapa indexado
+ * 
+ * Retorna:
+ * - Índice do território (0-based)
+ * - -1 se o território não pertence ao mapa indexado
+ */
+int indiceNoMapa(const struct Territorio* territorio) {
+    if (indiceAlvos.mapa == NULL || territorio < indiceAlvos.mapa ||
+        territorio >= indiceAlvos.mapa + indiceAlvos.tamanho) {
+        return -1;
+    }
+    return (int)(territorio - indiceAlvos.mapa);
+}
+
+/*
+ * Função para atualizar o índice após uma mudança em um território
+ * 
+ * Parâmetros:
+ * - territorio: ponteiro para o território alterado (tropas e/ou dono)
+ * 
+ * Custo O(log n). Territórios fora do mapa indexado são ignorados.
+ */
+void atualizarIndiceAlvos(struct Territorio* territorio) {
+    int i = indiceNoMapa(territorio);
+    if (!indiceAlvos.ativo || i == -1) {
+        return;
+    }
+    
+    int corAntiga = indiceAlvos.corDe[i];
+    int corNova = obterIdCor(territorio->cor);
+    
+    if (alteracoesPendentes.total < MAX_ALTERACOES_PENDENTES) {
+        alteracoesPendentes.indice[alteracoesPendentes.total] = i;
+        alteracoesPendentes.corAntiga[alteracoesPendentes.total++] = (unsigned char)corAntiga;
+    } else {
+        alteracoesPendentes.transbordou = 1;
+    }
+    
+    if (corNova < 0) {
+        // Cores demais para indexar: desativa o índice
+        liberarIndiceAlvos();
+        return;
+    }
+    
+    struct HeapTerritorios* fracos = &indiceAlvos.maisFracos[corAntiga];
+    struct HeapTerritorios* fortes = &indiceAlvos.maisFortes[corAntiga];
+    
+    if (corNova == corAntiga) {
+        // Apenas as tropas mudaram: reposiciona nos heaps do mesmo dono
+        heapSubir(fracos, indiceAlvos.posicaoFracos, indiceAlvos.posicaoFracos[i], 1);
+        heapDescer(fracos, indiceAlvos.posicaoFracos, indiceAlvos.posicaoFracos[i], 1);
+        heapSubir(fortes, indiceAlvos.posicaoFortes, indiceAlvos.posicaoFortes[i], 0);
+        heapDescer(fortes, indiceAlvos.posicaoFortes, indiceAlvos.posicaoFortes[i], 0);
+        return;
+    }
+    
+    // Troca de dono: move o território para os heaps da nova cor
+    heapRemover(fracos, indiceAlvos.posicaoFracos, indiceAlvos.posicaoFracos[i], 1);
+    heapRemover(fortes, indiceAlvos.posicaoFortes, indiceAlvos.posicaoFortes[i], 0);
+    indiceAlvos.corDe[i] = (unsigned char)corNova;
+    marcarPosse(corAntiga, i, 0);
+    
+    if (!heapInserir(&indiceAlvos.maisFracos[corNova], indiceAlvos.posicaoFracos, i, 1) ||
+        !heapInserir(&indiceAlvos.maisFortes[corNova], indiceAlvos.posicaoFortes, i, 0) ||
+        !marcarPosse(corNova, i, 1)) {
+        liberarIndiceAlvos();
+    }
+}
+
+/*
+ * Função para conferir o índice de alvos contra o mapa
+ * 
+ * Retorna:
+ * - 1 se cada território está nos heaps e no conjunto de posse do seu dono
+ *   atual, nas posições registradas, e todos os heaps respeitam a ordem
+ * - 0 caso contrário, ou se o índice não está ativo
+ * 
+ * Custo O(n). Usada pela bateria de regressão, não durante o jogo.
+ */
+int verificarIndiceAlvos() {
+    int noHeap = 0;
+    
+    if (!indiceAlvos.ativo) {
+        return 0;
+    }
+    
+    for (int i = 0; i < indiceAlvos.tamanho; i++) {
+        int cor = buscarIdCor(indiceAlvos.mapa[i].cor);
+        int pf = indiceAlvos.posicaoFracos[i];
+        int pF = indiceAlvos.posicaoFortes[i];
+        
+        if (cor < 0 || cor != indiceAlvos.corDe[i] || indiceAlvos.posse[cor] == NULL ||
+            !(indiceAlvos.posse[cor][i >> 6] & (1ULL << (i & 63)))) {
+            return 0;
+        }
+        if (pf < 0 || pf >= indiceAlvos.maisFracos[cor].tamanho ||
+            indiceAlvos.maisFracos[cor].itens[pf] != i ||
+            pF < 0 || pF >= indiceAlvos.maisFortes[cor].tamanho ||
+            indiceAlvos.maisFortes[cor].itens[pF] != i) {
+            return 0;
+        }
+    }
+    
+    for (int c = 0; c < MAX_CORES; c++) {
+        struct HeapTerritorios* fracos = &indiceAlvos.maisFracos[c];
+        struct HeapTerritorios* fortes = &indiceAlvos.maisFortes[c];
+        int bits = 0;
+        
+        if (fracos->tamanho != fortes->tamanho) {
+            return 0;
+        }
+        for (int p = 1; p < fracos->tamanho; p++) {
+            if (precedeNoHeap(fracos->itens[p], fracos->itens[(p - 1) / 2], 1) ||
+                precedeNoHeap(fortes->itens[p], fortes->itens[(p - 1) / 2], 0)) {
+                return 0;
+            }
+        }
+        for (int w = 0; indiceAlvos.posse[c] != NULL && w < indiceAlvos.palavras; w++) {
+            bits += __builtin_popcountll(indiceAlvos.posse[c][w]);
+        }
+        if (bits != fracos->tamanho) {
+            return 0;
+        }
+        noHeap += fracos->tamanho;
+    }
+    return noHeap == indiceAlvos.tamanho;
+}
+
+/*
+ * Função para buscar os k alvos inimigos mais fracos de uma cor
+ * 
+ * Parâmetros:
+ * - cor: identificador da cor do jogador que vai atacar
+ * - k: número máximo de alvos desejados
+ * - saida: vetor (com espaço para k itens) que recebe os índices dos alvos
+ * 
+ * Retorna:
+ * - Quantidade de alvos encontrados, em ordem crescente de tropas
+ * 
+ * Percorre os heaps das demais cores com uma fronteira própria: só visita
+ * os candidatos necessários, sem varrer o mapa inteiro.
+ */
+int buscarAlvosMaisFracos(int cor, int k, int* saida) {
+    if (!indiceAlvos.ativo || k <= 0) {
+        return 0;
+    }
+    
+    // Fronteira: pares (cor, posição no heap daquela cor), como heap mínimo
+    int capacidade = totalCores + 2 * k + 16;
+    int* fronteiraCor = (int*)malloc(capacidade * sizeof(int));
+    int* fronteiraPos = (int*)malloc(capacidade * sizeof(int));
+    int tamanhoFronteira = 0;
+    int encontrados = 0;
+    
+    if (fronteiraCor == NULL || fronteiraPos == NULL) {
+        free(fronteiraCor);
+        free(fronteiraPos);
+        return 0;
+    }
+    
+    for (int c = 0; c < totalCores; c++) {
+        if (c != cor && indiceAlvos.maisFracos[c].tamanho > 0) {
+            fronteiraCor[tamanhoFronteira] = c;
+            fronteiraPos[tamanhoFronteira] = 0;
+            tamanhoFronteira++;
+        }
+    }
+    
+    while (tamanhoFronteira > 0 && encontrados < k) {
+        // Extrai o candidato de menos tropas da fronteira
+        int melhor = 0;
+        for (int f = 1; f < tamanhoFronteira; f++) {
+            int a = indiceAlvos.maisFracos[fronteiraCor[f]].itens[fronteiraPos[f]];
+            int b = indiceAlvos.maisFracos[fronteiraCor[melhor]].itens[fronteiraPos[melhor]];
+            if (precedeNoHeap(a, b, 1)) {
+                melhor = f;
+            }
+        }
+        
+        int c = fronteiraCor[melhor];
+        int pos = fronteiraPos[melhor];
+        int territorio = indiceAlvos.maisFracos[c].itens[pos];
+        
+        tamanhoFronteira--;
+        fronteiraCor[melhor] = fronteiraCor[tamanhoFronteira];
+        fronteiraPos[melhor] = fronteiraPos[tamanhoFronteira];
+        
+        saida[encontrados++] = territorio;
+        
+        // Os filhos no heap de origem passam a ser candidatos
+        if (tamanhoFronteira + 2 > capacidade) {
+            capacidade *= 2;
+            int* novaCor = (int*)realloc(fronteiraCor, capacidade * sizeof(int));
+            if (novaCor != NULL) fronteiraCor = novaCor;
+            int* novaPos = (int*)realloc(fronteiraPos, capacidade * sizeof(int));
+            if (novaPos != NULL) fronteiraPos = novaPos;
+            if (novaCor == NULL || novaPos == NULL) {
+                break;
+            }
+        }
+        for (int filho = 2 * pos + 1; filho <= 2 * pos + 2; filho++) {
+            if (filho < indiceAlvos.maisFracos[c].tamanho) {
+                fronteiraCor[tamanhoFronteira] = c;
+                fronteiraPos[tamanhoFronteira] = filho;
+                tamanhoFronteira++;
+            }
+        }
+    }
+    
+    free(fronteiraCor);
+    free(fronteiraPos);
+    return encontrados;
+}
+
+/*
+ * Função para obter o território mais forte de uma cor
+ * 
+ * Parâmetros:
+ * - cor: identificador da cor
+ * 
+ * Retorna:
+ * - Índice do território com mais tropas da cor
+ * - -1 se a cor não controla territórios
+ */
+int territorioMaisForte(int cor) {
+    if (!indiceAlvos.ativo || cor < 0 || indiceAlvos.maisFortes[cor].tamanho == 0) {
+        return -1;
+    }
+    return indiceAlvos.maisFortes[cor].itens[0];
+}
+
+/*
+ * Função para buscar os k territórios mais fortes de uma cor
+ * 
+ * Parâmetros:
+ * - cor: identificador da cor
+ * - k: número máximo de territórios desejados
+ * - saida: vetor (com espaço para k itens) que recebe os índices
+ * 
+ * Retorna:
+ * - Quantidade de territórios encontrados, em ordem decrescente de tropas
+ */
+int buscarMaisFortesDaCor(int cor, int k, int* saida) {
+    if (!indiceAlvos.ativo || cor < 0 || k <= 0) {
+        return 0;
+    }
+    
+    struct HeapTerritorios* heap = &indiceAlvos.maisFortes[cor];
+    int* fronteira = (int*)malloc((2 * k + 1) * sizeof(int));  // Posições no heap
+    int tamanhoFronteira = 0;
+    int encontrados = 0;
+    
+    if (fronteira == NULL) {
+        return 0;
+    }
+    if (heap->tamanho > 0) {
+        fronteira[tamanhoFronteira++] = 0;
+    }
+    
+    while (tamanhoFronteira > 0 && encontrados < k) {
+        int melhor = 0;
+        for (int f = 1; f < tamanhoFronteira; f++) {
+            if (precedeNoHeap(heap->itens[fronteira[f]], heap->itens[fronteira[melhor]], 0)) {
+                melhor = f;
+            }
+        }
+        
+        int pos = fronteira[melhor];
+        fronteira[melhor] = fronteira[--tamanhoFronteira];
+        saida[encontrados++] = heap->itens[pos];
+        
+        for (int filho = 2 * pos + 1; filho <= 2 * pos + 2; filho++) {
+            if (filho < heap->tamanho) {
+                fronteira[tamanhoFronteira++] = filho;
+            }
+        }
+    }
+    
+    free(fronteira);
+    return encontrados;
+}
+
+/*
+ * Definição da estrutura AdjacenciaMapa
+ * 
+ * Fronteiras e regiões de um mapa carregado de arquivo (mapas cadastrados
+ * à mão não têm adjacência, e qualquer território pode atacar qualquer
+ * outro):
+ * - inicio/vizinhos: lista compacta; os vizinhos de i estão em
+ *   vizinhos[inicio[i] .. inicio[i + 1])
+ * - regiao: região de cada território
+ */
+struct AdjacenciaMapa {
+    int ativa;          // 1 se o mapa em jogo tem fronteiras
+    int largura;        // Largura da grade usada na geração
+    int totalRegioes;   // Número de regiões
+    int32_t* regiao;
+    int32_t* inicio;
+    int32_t* vizinhos;
+};
+
+// Adjacência do mapa em jogo
+struct AdjacenciaMapa adjacencia;
+
+/*
+ * Função para verificar se dois territórios fazem fronteira
+ * 
+ * Retorna:
+ * - 1 se fazem fronteira (ou se o mapa não tem adjacência)
+ * - 0 caso contrário
+ */
+int fazemFronteira(int a, int b) {
+    if (!adjacencia.ativa) {
+        return 1;
+    }
+    for (int k = adjacencia.inicio[a]; k < adjacencia.inicio[a + 1]; k++) {
+        if (adjacencia.vizinhos[k] == b) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Função para encontrar o melhor atacante de uma cor contra um alvo
+ * 
+ * Parâmetros:
+ * - cor: identificador da cor atacante
+ * - alvo: índice do território alvo
+ * 
+ * Retorna:
+ * - Índice do vizinho da cor com mais tropas (pelo menos 2), ou o território
+ *   mais forte da cor quando o mapa não tem adjacência
+ * - -1 se nenhum território da cor pode atacar o alvo
+ */
+int atacanteParaAlvo(int cor, int alvo) {
+    int melhor = -1;
+    
+    if (!adjacencia.ativa) {
+        melhor = territorioMaisForte(cor);
+    } else {
+        for (int k = adjacencia.inicio[alvo]; k < adjacencia.inicio[alvo + 1]; k++) {
+            int v = adjacencia.vizinhos[k];
+            if (indiceAlvos.corDe[v] == cor &&
+                (melhor == -1 || indiceAlvos.mapa[v].tropas > indiceAlvos.mapa[melhor].tropas)) {
+                melhor = v;
+            }
+        }
+    }
+    
+    if (melhor == -1 || indiceAlvos.mapa[melhor].tropas < 2) {
+        return -1;
+    }
+    return melhor;
+}
+
+/*
+ * Função de comparação para qsort: menos tropas primeiro (como maisFracos)
+ */
+int compararAlvos(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return x == y ? 0 : (precedeNoHeap(x, y, 1) ? -1 : 1);
+}
+
+/*
+ * Função para buscar os alvos mais fracos na fronteira de uma cor
+ * 
+ * Parâmetros:
+ * - cor: identificador da cor atacante
+ * - k: número máximo de alvos
+ * - saida: vetor com espaço para k índices
+ * 
+ * Retorna:
+ * - Número de alvos encontrados (inimigos vizinhos de um território da
+ *   cor com pelo menos 2 tropas), do mais fraco para o mais forte
+ * 
+ * Parte dos territórios da cor (conjunto de posse) em vez dos inimigos
+ * mais fracos: em mapas grandes, quase todos os inimigos fracos estão
+ * longe da fronteira, e filtrá-los um a um custaria o mapa inteiro.
+ */
+int buscarAlvosNaFronteira(int cor, int k, int* saida) {
+    if (!indiceAlvos.ativo || cor < 0 || indiceAlvos.posse[cor] == NULL || k <= 0) {
+        return 0;
+    }
+    
+    int capacidade = 64;
+    int total = 0;
+    int* candidatos = (int*)malloc(capacidade * sizeof(int));
+    if (candidatos == NULL) {
+        return 0;
+    }
+    
+    for (int p = 0; p < indiceAlvos.palavras; p++) {
+        uint64_t bits = indiceAlvos.posse[cor][p];
+        while (bits) {
+            int i = p * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (indiceAlvos.mapa[i].tropas < 2) {
+                continue;
+            }
+            
+            for (int a = adjacencia.inicio[i]; a < adjacencia.inicio[i + 1]; a++) {
+                int vizinho = adjacencia.vizinhos[a];
+                if (indiceAlvos.corDe[vizinho] == cor) {
+                    continue;
+                }
+                if (total == capacidade) {
+                    int* maior = (int*)realloc(candidatos, 2 * capacidade * sizeof(int));
+                    if (maior == NULL) {
+                        free(candidatos);
+                        return 0;
+                    }
+                    candidatos = maior;
+                    capacidade *= 2;
+                }
+                candidatos[total++] = vizinho;
+            }
+        }
+    }
+    
+    // Ordena e descarta repetidos (alvos vizinhos de mais de um território)
+    qsort(candidatos, total, sizeof(int), compararAlvos);
+    int encontrados = 0;
+    for (int c = 0; c < total && encontrados < k; c++) {
+        if (c == 0 || candidatos[c] != candidatos[c - 1]) {
+            saida[encontrados++] = candidatos[c];
+        }
+    }
+    
+    free(candidatos);
+    return encontrados;
+}
+
+/*
+ * Função para contar os territórios de uma cor
+ * 
+ * Parâmetros:
+ * - cor: identificador da cor (-1 representa uma cor ausente do mapa)
+ * 
+ * Retorna:
+ * - Número de territórios da cor, via popcount de 64 territórios por vez
+ */
+int contarPosse(int cor) {
+    if (cor < 0 || indiceAlvos.posse[cor] == NULL) {
+        return 0;
+    }
+    
+    const uint64_t* bits = indiceAlvos.posse[cor];
+    int total = 0;
+    for (int w = 0; w < indiceAlvos.palavras; w++) {
+        total += __builtin_popcountll(bits[w]);
+    }
+    return total;
+}
+
+/*
+ * Função para verificar se uma cor foi eliminada do mapa
+ * 
+ * Retorna:
+ * - 1 se a cor não controla nenhum território
+ * - 0 caso contrário
+ */
+int posseVazia(int cor) {
+    if (cor < 0 || indiceAlvos.posse[cor] == NULL) {
+        return 1;
+    }
+    
+    const uint64_t* bits = indiceAlvos.posse[cor];
+    for (int w = 0; w < indiceAlvos.palavras; w++) {
+        if (bits[w] != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Função para somar as tropas de uma cor
+ * 
+ * Percorre apenas os bits ligados, pulando palavras vazias inteiras.
+ */
+long long somarTropasPosse(int cor) {
+    if (cor < 0 || indiceAlvos.posse[cor] == NULL) {
+        return 0;
+    }
+    
+    const uint64_t* bits = indiceAlvos.posse[cor];
+    long long total = 0;
+    for (int w = 0; w < indiceAlvos.palavras; w++) {
+        uint64_t x = bits[w];
+        while (x != 0) {
+            total += indiceAlvos.mapa[(w << 6) + __builtin_ctzll(x)].tropas;
+            x &= x - 1;  // Desliga o bit menos significativo
+        }
+    }
+    return total;
+}
+
+/*
+ * Função para calcular a maior sequência de bits ligados consecutivos
+ * 
+ * Parâmetros:
+ * - bits: conjunto de bits (bit i da palavra w = território 64 * w + i)
+ * - palavras: número de palavras de 64 bits
+ * 
+ * Retorna:
+ * - Comprimento da maior sequência de territórios consecutivos
+ * 
+ * Palavras cheias e vazias são tratadas de uma vez; nas demais, o prefixo
+ * e o sufixo (que continuam sequências vizinhas) saem de ctz/clz e a maior
+ * sequência interna sai da erosão x & (x >> 1).
+ */
+int maiorSequenciaBits(const uint64_t* bits, int palavras) {
+    int maior = 0;
+    int atual = 0;  // Sequência que chega ao fim da palavra anterior
+    
+    for (int w = 0; w < palavras; w++) {
+        uint64_t x = bits[w];
+        
+        if (x == ~0ULL) {
+            atual += 64;
+            continue;
+        }
+        
+        // Prefixo: continua a sequência da palavra anterior
+        atual += __builtin_ctzll(~x);
+        if (atual > maior) maior = atual;
+        
+        // Maior sequência interna: número de erosões até zerar
+        int interna = 0;
+        for (uint64_t y = x; y != 0; y &= y >> 1) {
+            interna++;
+        }
+        if (interna > maior) maior = interna;
+        
+        // Sufixo: começa uma sequência que pode seguir na próxima palavra
+        atual = x ? __builtin_clzll(~x) : 0;
+    }
+    
+    return atual > maior ? atual : maior;
+}
+
+/*
+ * Função para exibir a missão do jogador
+ * 
+ * Parâmetros:
+ * - missao: string com a missão do jogador (passada por valor)
+ */
+void exibirMissao(char* missao) {
+    printf("\n=== SUA MISSÃO ESTRATÉGICA ===\n");
+    printf("Objetivo: %s\n", missao);
+    printf("==============================\n");
+}
+
+/*
+ * Função para verificar uma missão usando os conjuntos de posse do índice
+ * 
+ * Parâmetros:
+ * - missao: string com a missão a ser verificada
+ * - cor: identificador da cor do jogador (-1 se ausente do mapa)
+ * - tamanho: número de territórios no mapa
+ * 
+ * Retorna:
+ * - 1 se a missão foi cumprida
+ * - 0 caso contrário (mesmas regras de verificarMissao)
+ */
+int verificarMissaoPorPosse(char* missao, int cor, int tamanho) {
+    if (strcmp(missao, "Conquistar 3 territórios consecutivos") == 0) {
+        if (cor < 0 || indiceAlvos.posse[cor] == NULL) {
+            return 0;
+        }
+        return maiorSequenciaBits(indiceAlvos.posse[cor], indiceAlvos.palavras) >= 3;
+    }
+    
+    if (strcmp(missao, "Eliminar todas as tropas vermelhas do mapa") == 0) {
+        return posseVazia(buscarIdCor("Vermelho")) && posseVazia(buscarIdCor("vermelho"));
+    }
+    
+    if (strcmp(missao, "Controlar pelo menos 4 territórios") == 0) {
+        return contarPosse(cor) >= 4;
+    }
+    
+    if (strcmp(missao, "Ter mais de 2000 tropas no total") == 0) {
+        return somarTropasPosse(cor) > 2000;
+    }
+    
+    if (strcmp(missao, "Conquistar territórios de 3 cores diferentes") == 0) {
+        return contarPosse(cor) >= 3;
+    }
+    
+    if (strcmp(missao, "Controlar todos os territórios de uma região") == 0) {
+        return contarPosse(cor) >= (tamanho / 2);
+    }
+    
+    return 0;
+}
+
+/*
+ * Função para verificar se a missão de uma cor foi cumprida
+ * 
+ * Parâmetros:
+ * - missao: string com a missão a ser verificada (passada por valor)
+ * - mapa: ponteiro para o vetor de territórios
+ * - tamanho: número de territórios no mapa
+ * - cor: cor do exército dono da missão
+ * 
+ * Retorna:
+ * - 1 se a missão foi cumprida
+ * - 0 se a missão ainda não foi cumprida
+ */
+int verificarMissaoDaCor(char* missao, struct Territorio* mapa, int tamanho, const char* cor) {
+    MEDIR_ESCOPO(PONTO_MISSAO);
+    
+    // Com o índice ativo, as missões viram consultas aos conjuntos de posse
+    if (indiceAlvos.ativo && mapa == indiceAlvos.mapa && tamanho == indiceAlvos.tamanho) {
+        return verificarMissaoPorPosse(missao, buscarIdCor(cor), tamanho);
+    }
+    
+    // Missão 1: "Conquistar 3 territórios consecutivos"
+    if (strcmp(missao, "Conquistar 3 territórios consecutivos") == 0) {
+        int consecutivos = 0;
+        int maxConsecutivos = 0;
+        
+        for (int i = 0; i < tamanho; i++) {
+            if (strcmp(mapa[i].cor, cor) == 0) {
+                consecutivos++;
+                if (consecutivos > maxConsecutivos) {
+                    maxConsecutivos = consecutivos;
+                }
+            } else {
+                consecutivos = 0;
+            }
+        }
+        return maxConsecutivos >= 3;
+    }
+    
+    // Missão 2: "Eliminar todas as tropas vermelhas do mapa"
+    if (strcmp(missao, "Eliminar todas as tropas vermelhas do mapa") == 0) {
+        for (int i = 0; i < tamanho; i++) {
+            if (strcmp(mapa[i].cor, "Vermelho") == 0 || strcmp(mapa[i].cor, "vermelho") == 0) {
+                return 0; // Ainda existem territórios vermelhos
+            }
+        }
+        return 1; // Não há mais territórios vermelhos
+    }
+    
+    // Missão 3: "Controlar pelo menos 4 territórios"
+    if (strcmp(missao, "Controlar pelo menos 4 territórios") == 0) {
+        int territoriosControlados = 0;
+        
+        for (int i = 0; i < tamanho; i++) {
+            if (strcmp(mapa[i].cor, cor) == 0) {
+                territoriosControlados++;
+            }
+        }
+        return territoriosControlados >= 4;
+    }
+    
+    // Missão 4: "Ter mais de 2000 tropas no total"
+    if (strcmp(missao, "Ter mais de 2000 tropas no total") == 0) {
+        int totalTropas = 0;
+        
+        for (int i = 0; i < tamanho; i++) {
+            if (strcmp(mapa[i].cor, cor) == 0) {
+                totalTropas += mapa[i].tropas;
+            }
+        }
+        return totalTropas > 2000;
+    }
+    
+    // Missão 5: "Conquistar territórios de 3 cores diferentes"
+    if (strcmp(missao, "Conquistar territórios de 3 cores diferentes") == 0) {
+        // Simplificação: verificar se o jogador controla pelo menos 3 territórios
+        int territoriosControlados = 0;
+        
+        for (int i = 0; i < tamanho; i++) {
+            if (strcmp(mapa[i].cor, cor) == 0) {
+                territoriosControlados++;
+            }
+        }
+        return territoriosControlados >= 3;
+    }
+    
+    // Missão 6: "Controlar todos os territórios de uma região"
+    if (strcmp(missao, "Controlar todos os territórios de uma região") == 0) {
+        // Simplificação: controlar metade dos territórios
+        int territoriosControlados = 0;
+        
+        for (int i = 0; i < tamanho; i++) {
+            if (strcmp(mapa[i].cor, cor) == 0) {
+                territoriosControlados++;
+            }
+        }
+        return territoriosControlados >= (tamanho / 2);
+    }
+    
+    return 0; // Missão não reconhecida ou não cumprida
+}
+
+/*
+ * Função para verificar se a missão do jogador foi cumprida
+ * 
+ * Parâmetros:
+ * - missao: string com a missão a ser verificada (passada por valor)
+ * - mapa: ponteiro para o vetor de territórios
+ * - tamanho: número de territórios no mapa
+ * 
+ * Retorna:
+ * - 1 se a missão foi cumprida
+ * - 0 se a missão ainda não foi cumprida
+ */
+int verificarMissao(char* missao, struct Territorio* mapa, int tamanho) {
+    return verificarMissaoDaCor(missao, mapa, tamanho, corJogador);
+}
+
+/*
+ * Definição da estrutura EstatisticasJogador
+ * 
+ * Resumo de uma cor (jogador) calculado pela varredura estatística:
+ * - territorios: quantidade de territórios controlados
+ * - tropas: soma das tropas nesses territórios
+ * - coresConquistadas: bit c ligado = controla território que era da cor c
+ * - maiorSequencia: maior sequência de territórios consecutivos da cor
+ */
+struct EstatisticasJogador {
+    int territorios;
+    long long tropas;
+    uint64_t coresConquistadas;
+    int maiorSequencia;
+};
+
+/*
+ * Definição da estrutura EstatisticasMapa
+ * 
+ * Estatísticas de todas as cores de um trecho do mapa. Além dos totais por
+ * cor, guarda as sequências que tocam as bordas do trecho para que trechos
+ * vizinhos possam ser combinados sem nova varredura.
+ */
+struct EstatisticasMapa {
+    struct EstatisticasJogador jogador[MAX_CORES];
+    int inicio, fim;           // Trecho [inicio, fim) coberto
+    int corInicial, prefixo;   // Sequência que começa no início do trecho
+    int corFinal, sufixo;      // Sequência que termina no fim do trecho
+};
+
+/*
+ * Função para calcular as estatísticas de um trecho do mapa em uma passada
+ * 
+ * Parâmetros:
+ * - argumento: ponteiro para EstatisticasMapa com inicio e fim preenchidos
+ * 
+ * Assinatura compatível com pthread_create.
+ */
+void* varrerTrechoEstatisticas(void* argumento) {
+    struct EstatisticasMapa* parcial = (struct EstatisticasMapa*)argumento;
+    const unsigned char* corDe = indiceAlvos.corDe;
+    const unsigned char* corOriginal = indiceAlvos.corOriginal;
+    const struct Territorio* mapa = indiceAlvos.mapa;
+    int corAnterior = -1;
+    int sequencia = 0;
+    
+    memset(parcial->jogador, 0, sizeof(parcial->jogador));
+    parcial->corInicial = parcial->corFinal = -1;
+    parcial->prefixo = parcial->sufixo = 0;
+    
+    for (int i = parcial->inicio; i < parcial->fim; i++) {
+        int cor = corDe[i];
+        struct EstatisticasJogador* j = &parcial->jogador[cor];
+        
+        j->territorios++;
+        j->tropas += mapa[i].tropas;
+        if (corOriginal[i] != cor) {
+            j->coresConquistadas |= 1ULL << corOriginal[i];
+        }
+        
+        sequencia = (cor == corAnterior) ? sequencia + 1 : 1;
+        corAnterior = cor;
+        if (sequencia > j->maiorSequencia) {
+            j->maiorSequencia = sequencia;
+        }
+        if (sequencia == i - parcial->inicio + 1) {
+            parcial->prefixo = sequencia;  // Ainda na primeira sequência
+        }
+    }
+    
+    if (parcial->fim > parcial->inicio) {
+        parcial->corInicial = corDe[parcial->inicio];
+        parcial->corFinal = corAnterior;
+        parcial->sufixo = sequencia;
+    }
+    return NULL;
+}
+
+/*
+ * Função para acumular as estatísticas de um trecho no trecho anterior
+ * 
+ * Parâmetros:
+ * - total: estatísticas acumuladas do início do mapa até o trecho atual
+ * - parcial: estatísticas do trecho seguinte (imediatamente à direita)
+ */
+void combinarEstatisticas(struct EstatisticasMapa* total, const struct EstatisticasMapa* parcial) {
+    if (parcial->fim <= parcial->inicio) {
+        return;
+    }
+    if (total->fim <= total->inicio) {
+        *total = *parcial;
+        return;
+    }
+    
+    for (int c = 0; c < totalCores; c++) {
+        struct EstatisticasJogador* a = &total->jogador[c];
+        const struct EstatisticasJogador* b = &parcial->jogador[c];
+        a->territorios += b->territorios;
+        a->tropas += b->tropas;
+        a->coresConquistadas |= b->coresConquistadas;
+        if (b->maiorSequencia > a->maiorSequencia) {
+            a->maiorSequencia = b->maiorSequencia;
+        }
+    }
+    
+    int tamanhoTotal = total->fim - total->inicio;
+    int tamanhoParcial = parcial->fim - parcial->inicio;
+    int prefixo = total->prefixo;
+    int sufixo = parcial->sufixo;
+    
+    // Sequência que atravessa a fronteira entre os dois trechos
+    if (total->corFinal == parcial->corInicial) {
+        int unida = total->sufixo + parcial->prefixo;
+        if (unida > total->jogador[parcial->corInicial].maiorSequencia) {
+            total->jogador[parcial->corInicial].maiorSequencia = unida;
+        }
+        if (total->prefixo == tamanhoTotal) prefixo = unida;
+        if (parcial->sufixo == tamanhoParcial) sufixo = unida;
+    }
+    
+    total->prefixo = prefixo;
+    total->sufixo = sufixo;
+    total->corFinal = parcial->corFinal;
+    total->fim = parcial->fim;
+}
+
+/*
+ * Função para calcular as estatísticas de todas as cores de uma só vez
+ * 
+ * Parâmetros:
+ * - resultado: ponteiro para a estrutura que recebe as estatísticas
+ * 
+ * Retorna:
+ * - 1 em caso de sucesso
+ * - 0 se o índice do mapa não está ativo
+ * 
+ * Uma única passada pelo mapa, qualquer que seja o número de jogadores.
+ * Mapas grandes são divididos em trechos varridos em paralelo e combinados
+ * em ordem ao final.
+ */
+int calcularEstatisticas(struct EstatisticasMapa* resultado) {
+    if (!indiceAlvos.ativo) {
+        return 0;
+    }
+    
+    int tamanho = indiceAlvos.tamanho;
+    int numThreads = trechosDeVarredura(tamanho);
+    
+    if (numThreads <= 1) {
+        resultado->inicio = 0;
+        resultado->fim = tamanho;
+        varrerTrechoEstatisticas(resultado);
+        return 1;
+    }
+    
+    struct EstatisticasMapa* parciais =
+        (struct EstatisticasMapa*)malloc(numThreads * sizeof(struct EstatisticasMapa));
+    pthread_t threads[MAX_THREADS];
+    int criadas[MAX_THREADS];
+    
+    if (parciais == NULL) {
+        resultado->inicio = 0;
+        resultado->fim = tamanho;
+        varrerTrechoEstatisticas(resultado);
+        return 1;
+    }
+    
+    for (int t = 0; t < numThreads; t++) {
+        parciais[t].inicio = (int)((long long)tamanho * t / numThreads);
+        parciais[t].fim = (int)((long long)tamanho * (t + 1) / numThreads);
+        criadas[t] = (t > 0 &&
+                      criarThreadDoTrecho(&threads[t], t, varrerTrechoEstatisticas, &parciais[t]) == 0);
+    }
+    
+    // A thread principal varre o primeiro trecho e os que não ganharam thread
+    cpu_set_t afinidade;
+    int fixada = fixarChamadoraNoTrecho(0, &afinidade);
+    for (int t = 0; t < numThreads; t++) {
+        if (!criadas[t]) varrerTrechoEstatisticas(&parciais[t]);
+    }
+    if (fixada) restaurarAfinidade(&afinidade);
+    for (int t = 1; t < numThreads; t++) {
+        if (criadas[t]) pthread_join(threads[t], NULL);
+    }
+    
+    resultado->inicio = resultado->fim = 0;
+    for (int t = 0; t < numThreads; t++) {
+        combinarEstatisticas(resultado, &parciais[t]);
+    }
+    
+    free(parciais);
+    return 1;
+}
+
+/*
+ * Função para verificar uma missão a partir das estatísticas de uma cor
+ * 
+ * Parâmetros:
+ * - missao: string com a missão a ser verificada
+ * - estatisticas: estatísticas de todas as cores do mapa
+ * - cor: identificador da cor do jogador (-1 se ausente do mapa)
+ * 
+ * Retorna:
+ * - 1 se a missão foi cumprida
+ * - 0 caso contrário (mesmas regras de verificarMissao)
+ */
+int verificarMissaoPorEstatisticas(char* missao, const struct EstatisticasMapa* estatisticas, int cor) {
+    static const struct EstatisticasJogador vazio;
+    const struct EstatisticasJogador* j = (cor >= 0) ? &estatisticas->jogador[cor] : &vazio;
+    int tamanho = estatisticas->fim - estatisticas->inicio;
+    
+    if (strcmp(missao, "Conquistar 3 territórios consecutivos") == 0) {
+        return j->maiorSequencia >= 3;
+    }
+    
+    if (strcmp(missao, "Eliminar todas as tropas vermelhas do mapa") == 0) {
+        int vermelho = buscarIdCor("Vermelho");
+        int vermelhoMinusculo = buscarIdCor("vermelho");
+        return (vermelho < 0 || estatisticas->jogador[vermelho].territorios == 0) &&
+               (vermelhoMinusculo < 0 || estatisticas->jogador[vermelhoMinusculo].territorios == 0);
+    }
+    
+    if (strcmp(missao, "Controlar pelo menos 4 territórios") == 0) {
+        return j->territorios >= 4;
+    }
+    
+    if (strcmp(missao, "Ter mais de 2000 tropas no total") == 0) {
+        return j->tropas > 2000;
+    }
+    
+    if (strcmp(missao, "Conquistar territórios de 3 cores diferentes") == 0) {
+        return j->territorios >= 3;
+    }
+    
+    if (strcmp(missao, "Controlar todos os territórios de uma região") == 0) {
+        return j->territorios >= (tamanho / 2);
+    }
+    
+    return 0;
+}
+
+/*
+ * Entrada de dados e comandos
+ * 
+ * Toda a entrada do jogo (cadastro, perguntas e comandos de batalha) passa
+ * por um único leitor com buffer grande sobre a entrada padrão ou sobre um
+ * script (--script). Cada read() traz tudo o que já está disponível, e as
+ * palavras e linhas são separadas à mão no buffer, sem scanf: um programa
+ * que alimenta o jogo por um pipe pode mandar milhares de comandos por
+ * segundo pelo mesmo caminho do jogador humano.
+ */
+#define TAMANHO_BUFFER_ENTRADA 65536
+
+// Maior linha de comando aceita (linhas maiores são rejeitadas inteiras)
+#define TAMANHO_LINHA_COMANDO 256
+
+struct LeitorEntrada {
+    int descritor;     // Entrada padrão ou arquivo de script
+    int interativo;    // 1 se a entrada é um terminal (mostra as perguntas)
+    int encerrado;     // 1 depois do fim da entrada
+    size_t inicio;     // Próximo byte não lido do buffer
+    size_t fim;        // Bytes válidos no buffer
+    long linha;        // Linha atual (para mensagens de erro)
+    char buffer[TAMANHO_BUFFER_ENTRADA];
+};
+
+// Leitor de toda a entrada do jogo
+struct LeitorEntrada leitor = { 0, 1, 0, 0, 0, 1, { 0 } };
+
+// Script de comandos (--script=ARQUIVO; NULL = entrada padrão)
+const char* caminhoScript = NULL;
+
+/*
+ * Função para ligar o leitor a um descritor de arquivo
+ */
+void iniciarLeitor(int descritor) {
+    leitor.descritor = descritor;
+    leitor.interativo = isatty(descritor);
+    leitor.encerrado = 0;
+    leitor.inicio = leitor.fim = 0;
+    leitor.linha = 1;
+}
+
+/*
+ * Função para garantir bytes no buffer do leitor
+ * 
+ * Retorna:
+ * - 1 se há bytes para ler
+ * - 0 no fim da entrada
+ */
+int abastecerLeitor() {
+    if (leitor.inicio < leitor.fim) {
+        return 1;
+    }
+    if (leitor.encerrado) {
+        return 0;
+    }
+    
+    fflush(stdout);  // A pergunta tem de aparecer antes de esperar a resposta
+    ssize_t lidos;
+    do {
+        lidos = read(leitor.descritor, leitor.buffer, sizeof(leitor.buffer));
+    } while (lidos < 0 && errno == EINTR);
+    
+    if (lidos <= 0) {
+        leitor.encerrado = 1;
+        return 0;
+    }
+    leitor.inicio = 0;
+    leitor.fim = (size_t)lidos;
+    return 1;
+}
+
+/*
+ * Função para ler a próxima palavra da entrada (como scanf("%s"))
+ * 
+ * Parâmetros:
+ * - destino: onde a palavra é escrita
+ * - tamanho: tamanho de destino; o excesso da palavra é descartado
+ * 
+ * Retorna:
+ * - 1 se uma palavra foi lida
+ * - 0 no fim da entrada
+ */
+int lerPalavra(char* destino, size_t tamanho) {
+    MEDIR_ESCOPO(PONTO_ENTRADA);
+    size_t escritos = 0;
+    
+    // Pula espaços e quebras de linha
+    while (1) {
+        if (!abastecerLeitor()) {
+            destino[0] = '\0';
+            return 0;
+        }
+        char c = leitor.buffer[leitor.inicio];
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            break;
+        }
+        leitor.linha += (c == '\n');
+        leitor.inicio++;
+    }
+    
+    while (abastecerLeitor()) {
+        char c = leitor.buffer[leitor.inicio];
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            break;
+        }
+        if (escritos + 1 < tamanho) {
+            destino[escritos++] = c;
+        }
+        leitor.inicio++;
+    }
+    destino[escritos] = '\0';
+    return 1;
+}
+
+/*
+ * Função para ler um número inteiro da entrada
+ * 
+ * Parâmetros:
+ * - valor: recebe o número
+ * 
+ * Retorna:
+ * - 1 se um número foi lido
+ * - 0 no fim da entrada
+ * - -1 se a palavra lida não é um número (ela é descartada)
+ */
+int lerInteiro(int* valor) {
+    char palavra[24];
+    char* fim;
+    
+    if (!lerPalavra(palavra, sizeof(palavra))) {
+        return 0;
+    }
+    long numero = strtol(palavra, &fim, 10);
+    if (fim == palavra || *fim != '\0' || numero < INT32_MIN || numero > INT32_MAX) {
+        return -1;
+    }
+    *valor = (int)numero;
+    return 1;
+}
+
+/*
+ * Função para ler uma linha inteira da entrada
+ * 
+ * Parâmetros:
+ * - destino: onde a linha é escrita, sem a quebra de linha
+ * - tamanho: tamanho de destino
+ * 
+ * Retorna:
+ * - Tamanho da linha
+ * - -1 no fim da entrada
+ * - -2 se a linha não coube em destino (ela é descartada inteira)
+ */
+int lerLinha(char* destino, size_t tamanho) {
+    MEDIR_ESCOPO(PONTO_ENTRADA);
+    size_t escritos = 0;
+    int cortada = 0;
+    
+    if (!abastecerLeitor()) {
+        return -1;
+    }
+    
+    while (abastecerLeitor()) {
+        const char* inicio = leitor.buffer + leitor.inicio;
+        size_t disponiveis = leitor.fim - leitor.inicio;
+        const char* quebra = (const char*)memchr(inicio, '\n', disponiveis);
+        size_t trecho = quebra ? (size_t)(quebra - inicio) : disponiveis;
+        
+        if (escritos + trecho < tamanho) {
+            memcpy(destino + escritos, inicio, trecho);
+            escritos += trecho;
+        } else {
+            cortada = 1;
+        }
+        
+        leitor.inicio += trecho;
+        if (quebra) {
+            leitor.inicio++;
+            break;
+        }
+    }
+    leitor.linha++;
+    
+    if (cortada) {
+        destino[0] = '\0';
+        return -2;
+    }
+    if (escritos > 0 && destino[escritos - 1] == '\r') {
+        escritos--;
+    }
+    destino[escritos] = '\0';
+    return (int)escritos;
+}
+
+/*
+ * Função para cadastrar os territórios usando ponteiros
+ * 
+ * Parâmetros:
+ * - mapa: ponteiro para o vetor de territórios
+ * - quantidade: número de territórios a serem cadastrados
+ * 
+ * Retorna:
+ * - 1 se todos os territórios foram cadastrados
+ * - 0 se a entrada terminou antes
+ */
+int cadastrarTerritorios(struct Territorio* mapa, int quantidade) {
+    printf("\n=================================================\n");
+    printf("           CADASTRO DE TERRITÓRIOS\n");
+    printf("=================================================\n");
+    
+    for (int i = 0; i < quantidade; i++) {
+        printf("\n--- Cadastro do Território %d ---\n", i + 1);
+        
+        // Entrada do nome do território usando ponteiro
+        printf("Digite o nome do território: ");
+        if (!lerPalavra((mapa + i)->nome, sizeof((mapa + i)->nome))) {  // Acesso via ponteiro
+            return 0;
+        }
+        
+        // Entrada da cor do exército usando ponteiro
+        printf("Digite a cor do exército: ");
+        if (!lerPalavra((mapa + i)->cor, sizeof((mapa + i)->cor))) {    // Acesso via ponteiro
+            return 0;
+        }
+        
+        // Entrada da quantidade de tropas usando ponteiro (repete até ser um número)
+        int lido;
+        printf("Digite a quantidade de tropas: ");
+        while ((lido = lerInteiro(&((mapa + i)->tropas))) == -1) { // Acesso via ponteiro
+            printf("Erro: Digite um número inteiro de tropas: ");
+        }
+        if (lido == 0) {
+            return 0;
+        }
+        
+        printf("Território '%s' cadastrado com sucesso!\n", (mapa + i)->nome);
+    }
+    return 1;
+}
+
+/*
+ * Formato de arquivo de mapa (binário, ordem de bytes da máquina)
+ * 
+ * - CabecalhoMapa
+ * - struct Territorio[quantidade]
+ * - int32 regiao[quantidade]
+ * - int32 inicio[quantidade + 1]   (lista de vizinhos compacta)
+ * - int32 vizinhos[totalVizinhos]
+ * 
+ * Todas as seções têm tamanho conhecido a partir do cabeçalho, então cada
+ * thread do gerador escreve a sua fatia diretamente na posição final.
+ */
+struct CabecalhoMapa {
+    char assinatura[8];      // "WARMAPA1"
+    int32_t quantidade;      // Número de territórios
+    int32_t largura;         // Largura da grade (0 = sem adjacência)
+    int32_t totalRegioes;    // Número de regiões
+    int32_t tamanhoRegistro; // sizeof(struct Territorio), para conferência
+    int64_t totalVizinhos;   // Entradas da lista de vizinhos
+};
+
+_Static_assert(sizeof(struct CabecalhoMapa) == 32, "CabecalhoMapa deve ter 32 bytes");
+
+// Distribuições de cores do gerador
+#define CORES_UNIFORMES 0   // Cada território sorteia a cor
+#define CORES_POR_REGIAO 1  // Cada região tem uma cor dominante (70%)
+
+// Distribuições de tropas do gerador
+#define TROPAS_UNIFORMES 0     // 1 a tropasMaximas
+#define TROPAS_EXPONENCIAIS 1  // Muitos territórios fracos, poucos fortes
+
+// Territórios gerados por bloco de escrita
+#define BLOCO_GERACAO 65536
+
+/*
+ * Definição da estrutura ParametrosGerador
+ * 
+ * Configuração de um mapa sintético (ver --gerar-mapa)
+ */
+struct ParametrosGerador {
+    int quantidade;
+    int cores;
+    int regioes;
+    int distribuicaoCores;
+    int distribuicaoTropas;
+    int tropasMaximas;
+    uint64_t semente;
+    int numThreads;
+};
+
+// Mapa gerado por --gerar-mapa (quantidade 0 = não pedido; regioes 0 = automático)
+struct ParametrosGerador parametrosGerador = { 0, 4, 0, CORES_POR_REGIAO, TROPAS_UNIFORMES, 10, 0, 0 };
+const char* caminhoMapaGerado = NULL;
+
+// Mapa carregado por --mapa no lugar do cadastro
+const char* caminhoMapa = NULL;
+
+// Nomes das primeiras cores; as seguintes são "Cor10", "Cor11", ...
+const char* paletaCores[] = {
+    "Azul", "Vermelho", "Verde", "Amarelo", "Preto",
+    "Branco", "Roxo", "Laranja", "Rosa", "Cinza"
+};
+
+/*
+ * Função para embaralhar os bits de um valor de 64 bits (finalizador splitmix64)
+ */
+static inline uint64_t misturarBits(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/*
+ * Função para sortear um valor determinístico de um território
+ * 
+ * Parâmetros:
+ * - semente: semente do mapa
+ * - item: índice do território (ou da região, ou da célula da grade)
+ * - canal: qual atributo está sendo sorteado
+ * 
+ * Não depende de ordem de geração, então qualquer divisão entre threads
+ * produz exatamente o mesmo mapa.
+ */
+static inline uint64_t sortearDoItem(uint64_t semente, uint64_t item, uint64_t canal) {
+    return misturarBits(semente ^ misturarBits(item * 0x9E3779B97F4A7C15ULL + canal));
+}
+
+/*
+ * Definição da estrutura GradeMapa
+ * 
+ * Geometria de um mapa gerado: os territórios ocupam uma grade de
+ * 'largura' colunas, linha a linha. Cada quadrado da grade recebe uma das
+ * duas diagonais, o que dá até 8 vizinhos por território e mantém o grafo
+ * planar. As regiões são blocos de 'ladoRegiao' x 'ladoRegiao' células.
+ */
+struct GradeMapa {
+    int quantidade;
+    int largura;
+    int ladoRegiao;
+    int regioesPorLinha;
+    int totalRegioes;
+    uint64_t semente;
+};
+
+/*
+ * Função para calcular a geometria da grade de um mapa
+ */
+void calcularGrade(struct GradeMapa* grade, int quantidade, int regioes, uint64_t semente) {
+    int largura = 1;
+    while ((long long)largura * largura < quantidade) {
+        largura++;
+    }
+    
+    int lado = 1;
+    if (regioes > 0) {
+        while ((long long)(lado + 1) * (lado + 1) * regioes <= (long long)quantidade) {
+            lado++;
+        }
+    }
+    
+    int linhas = (quantidade + largura - 1) / largura;
+    grade->quantidade = quantidade;
+    grade->largura = largura;
+    grade->ladoRegiao = lado;
+    grade->regioesPorLinha = (largura + lado - 1) / lado;
+    grade->totalRegioes = grade->regioesPorLinha * ((linhas + lado - 1) / lado);
+    grade->semente = semente;
+}
+
+/*
+ * Função para saber qual diagonal um quadrado da grade recebeu
+ * 
+ * Retorna:
+ * - 1 para a diagonal (x, y)-(x + 1, y + 1)
+ * - 0 para a diagonal (x + 1, y)-(x, y + 1)
+ */
+static inline int diagonalPrincipal(const struct GradeMapa* grade, int x, int y) {
+    return (int)(sortearDoItem(grade->semente, (uint64_t)y * grade->largura + x, 7) & 1);
+}
+
+/*
+ * Função para listar os vizinhos de um território da grade
+ * 
+ * Parâmetros:
+ * - grade: geometria do mapa
+ * - i: índice do território
+ * - saida: vetor com espaço para 8 vizinhos
+ * 
+ * Retorna:
+ * - Número de vizinhos
+ */
+int vizinhosNaGrade(const struct GradeMapa* grade, int i, int32_t* saida) {
+    int largura = grade->largura;
+    int n = grade->quantidade;
+    int x = i % largura;
+    int y = i / largura;
+    int k = 0;
+    
+    // Vizinhos ortogonais
+    if (x > 0) saida[k++] = i - 1;
+    if (x + 1 < largura && i + 1 < n) saida[k++] = i + 1;
+    if (y > 0) saida[k++] = i - largura;
+    if (i + largura < n) saida[k++] = i + largura;
+    
+    // Diagonais dos quatro quadrados que têm este território como canto
+    if (x + 1 < largura && i + largura + 1 < n && diagonalPrincipal(grade, x, y)) {
+        saida[k++] = i + largura + 1;
+    }
+    if (x > 0 && y > 0 && diagonalPrincipal(grade, x - 1, y - 1)) {
+        saida[k++] = i - largura - 1;
+    }
+    if (x > 0 && i + largura - 1 < n && !diagonalPrincipal(grade, x - 1, y)) {
+        saida[k++] = i + largura - 1;
+    }
+    if (x + 1 < largura && y > 0 && !diagonalPrincipal(grade, x, y - 1)) {
+        saida[k++] = i - largura + 1;
+    }
+    
+    return k;
+}
+
+/*
+ * Função para gerar os dados de um território sintético
+ * 
+ * Parâmetros:
+ * - parametros: configuração do mapa
+ * - grade: geometria do mapa
+ * - i: índice do território
+ * - territorio: ponteiro para onde o território é escrito
+ * - regiao: ponteiro para onde a região é escrita
+ */
+void gerarTerritorio(const struct ParametrosGerador* parametros, const struct GradeMapa* grade,
+                     int i, struct Territorio* territorio, int32_t* regiao) {
+    int x = i % grade->largura;
+    int y = i / grade->largura;
+    int r = (y / grade->ladoRegiao) * grade->regioesPorLinha + x / grade->ladoRegiao;
+    int cor;
+    
+    if (parametros->distribuicaoCores == CORES_POR_REGIAO &&
+        sortearDoItem(parametros->semente, i, 1) % 100 < 70) {
+        cor = (int)(sortearDoItem(parametros->semente, r, 2) % parametros->cores);
+    } else {
+        cor = (int)(sortearDoItem(parametros->semente, i, 3) % parametros->cores);
+    }
+    
+    uint64_t sorteio = sortearDoItem(parametros->semente, i, 4);
+    int tropas;
+    if (parametros->distribuicaoTropas == TROPAS_EXPONENCIAIS) {
+        // -ln(u) com u em (0, 1]: média de um quarto do máximo
+        double u = ((sorteio >> 11) + 1) * (1.0 / 9007199254740992.0);
+        tropas = 1 + (int)(-log(u) * parametros->tropasMaximas / 4);
+        if (tropas > parametros->tropasMaximas) tropas = parametros->tropasMaximas;
+    } else {
+        tropas = 1 + (int)(sorteio % parametros->tropasMaximas);
+    }
+    
+    memset(territorio, 0, sizeof(*territorio));
+    snprintf(territorio->nome, sizeof(territorio->nome), "R%d-T%d", r + 1, i + 1);
+    if (cor < (int)(sizeof(paletaCores) / sizeof(paletaCores[0]))) {
+        snprintf(territorio->cor, sizeof(territorio->cor), "%s", paletaCores[cor]);
+    } else {
+        snprintf(territorio->cor, sizeof(territorio->cor), "Cor%d", cor % MAX_CORES);
+    }
+    territorio->tropas = tropas;
+    *regiao = r;
+}
+
+/*
+ * Definição da estrutura FatiaGerador
+ * 
+ * Trabalho de uma thread do gerador: territórios [inicio, fim).
+ */
+struct FatiaGerador {
+    const struct ParametrosGerador* parametros;
+    const struct GradeMapa* grade;
+    int arquivo;              // Descritor do arquivo de saída
+    int inicio, fim;
+    long long vizinhos;       // Passada 1: vizinhos da fatia
+    long long primeiroVizinho; // Passada 2: posição do primeiro vizinho da fatia
+    int erro;                 // 1 se alguma escrita falhou
+};
+
+/*
+ * Função para escrever um bloco inteiro em uma posição do arquivo
+ */
+int escreverNaPosicao(int arquivo, const void* dados, size_t tamanho, off_t posicao) {
+    const char* p = (const char*)dados;
+    while (tamanho > 0) {
+        ssize_t escrito = pwrite(arquivo, p, tamanho, posicao);
+        if (escrito <= 0) {
+            return 0;
+        }
+        p += escrito;
+        tamanho -= (size_t)escrito;
+        posicao += escrito;
+    }
+    return 1;
+}
+
+/*
+ * Passada 1 do gerador: conta os vizinhos de uma fatia
+ */
+void* contarVizinhosFatia(void* argumento) {
+    struct FatiaGerador* fatia = (struct FatiaGerador*)argumento;
+    int32_t vizinhos[8];
+    
+    fatia->vizinhos = 0;
+    for (int i = fatia->inicio; i < fatia->fim; i++) {
+        fatia->vizinhos += vizinhosNaGrade(fatia->grade, i, vizinhos);
+    }
+    return NULL;
+}
+
+/*
+ * Passada 2 do gerador: gera e escreve uma fatia em blocos
+ */
+void* escreverFatia(void* argumento) {
+    struct FatiaGerador* fatia = (struct FatiaGerador*)argumento;
+    int n = fatia->parametros->quantidade;
+    off_t posTerritorios = sizeof(struct CabecalhoMapa);
+    off_t posRegioes = posTerritorios + (off_t)n * sizeof(struct Territorio);
+    off_t posInicio = posRegioes + (off_t)n * sizeof(int32_t);
+    off_t posVizinhos = posInicio + (off_t)(n + 1) * sizeof(int32_t);
+    long long proximoVizinho = fatia->primeiroVizinho;
+    
+    struct Territorio* territorios = (struct Territorio*)malloc(BLOCO_GERACAO * sizeof(struct Territorio));
+    int32_t* regioes = (int32_t*)malloc(BLOCO_GERACAO * sizeof(int32_t));
+    int32_t* inicios = (int32_t*)malloc((BLOCO_GERACAO + 1) * sizeof(int32_t));
+    int32_t* vizinhos = (int32_t*)malloc(8 * BLOCO_GERACAO * sizeof(int32_t));
+    
+    fatia->erro = (territorios == NULL || regioes == NULL || inicios == NULL || vizinhos == NULL);
+    
+    for (int bloco = fatia->inicio; bloco < fatia->fim && !fatia->erro; bloco += BLOCO_GERACAO) {
+        int quantos = fatia->fim - bloco < BLOCO_GERACAO ? fatia->fim - bloco : BLOCO_GERACAO;
+        long long primeiroDoBloco = proximoVizinho;
+        int totalVizinhos = 0;
+        
+        for (int j = 0; j < quantos; j++) {
+            gerarTerritorio(fatia->parametros, fatia->grade, bloco + j, &territorios[j], &regioes[j]);
+            inicios[j] = (int32_t)(primeiroDoBloco + totalVizinhos);
+            totalVizinhos += vizinhosNaGrade(fatia->grade, bloco + j, vizinhos + totalVizinhos);
+        }
+        proximoVizinho += totalVizinhos;
+        
+        // A última fatia também escreve o fim da lista de vizinhos
+        int inicioExtra = (bloco + quantos == n) ? 1 : 0;
+        inicios[quantos] = (int32_t)proximoVizinho;
+        
+        fatia->erro =
+            !escreverNaPosicao(fatia->arquivo, territorios, quantos * sizeof(struct Territorio),
+                               posTerritorios + (off_t)bloco * sizeof(struct Territorio)) ||
+            !escreverNaPosicao(fatia->arquivo, regioes, quantos * sizeof(int32_t),
+                               posRegioes + (off_t)bloco * sizeof(int32_t)) ||
+            !escreverNaPosicao(fatia->arquivo, inicios, (quantos + inicioExtra) * sizeof(int32_t),
+                               posInicio + (off_t)bloco * sizeof(int32_t)) ||
+            !escreverNaPosicao(fatia->arquivo, vizinhos, totalVizinhos * sizeof(int32_t),
+                               posVizinhos + (off_t)primeiroDoBloco * sizeof(int32_t));
+    }
+    
+    free(territorios);
+    free(regioes);
+    free(inicios);
+    free(vizinhos);
+    return NULL;
+}
+
+/*
+ * Função para executar uma passada do gerador em todas as fatias
+ * 
+ * A thread chamadora executa a primeira fatia e as que não ganharam thread.
+ */
+void executarFatias(struct FatiaGerador* fatias, int numFatias, void* (*passada)(void*)) {
+    pthread_t threads[MAX_THREADS];
+    int criadas[MAX_THREADS];
+    
+    for (int t = 0; t < numFatias; t++) {
+        criadas[t] = (t > 0 && pthread_create(&threads[t], NULL, passada, &fatias[t]) == 0);
+    }
+    for (int t = 0; t < numFatias; t++) {
+        if (!criadas[t]) passada(&fatias[t]);
+    }
+    for (int t = 0; t < numFatias; t++) {
+        if (criadas[t]) pthread_join(threads[t], NULL);
+    }
+}
+
+/*
+ * Função para gerar um mapa sintético direto em arquivo
+ * 
+ * Parâmetros:
+ * - caminho: arquivo de saída (formato de CabecalhoMapa)
+ * - parametros: configuração do mapa
+ * 
+ * Retorna:
+ * - 1 em caso de sucesso
+ * - 0 em caso de erro (mensagem já exibida)
+ * 
+ * Duas passadas paralelas: a primeira conta os vizinhos de cada fatia para
+ * calcular onde cada uma começa na lista de vizinhos; a segunda gera os
+ * territórios e escreve cada fatia na sua posição final do arquivo.
+ */
+int gerarMapa(const char* caminho, const struct ParametrosGerador* parametros) {
+    struct GradeMapa grade;
+    struct FatiaGerador fatias[MAX_THREADS];
+    int numThreads = parametros->numThreads;
+    
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAX_THREADS) numThreads = MAX_THREADS;
+    if (numThreads > parametros->quantidade) numThreads = parametros->quantidade;
+    
+    calcularGrade(&grade, parametros->quantidade, parametros->regioes, parametros->semente);
+    
+    int arquivo = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (arquivo < 0) {
+        printf("Erro: Não foi possível criar o arquivo de mapa '%s'!\n", caminho);
+        return 0;
+    }
+    
+    for (int t = 0; t < numThreads; t++) {
+        fatias[t].parametros = parametros;
+        fatias[t].grade = &grade;
+        fatias[t].arquivo = arquivo;
+        fatias[t].inicio = (int)((long long)parametros->quantidade * t / numThreads);
+        fatias[t].fim = (int)((long long)parametros->quantidade * (t + 1) / numThreads);
+        fatias[t].erro = 0;
+    }
+    
+    executarFatias(fatias, numThreads, contarVizinhosFatia);
+    
+    long long totalVizinhos = 0;
+    for (int t = 0; t < numThreads; t++) {
+        fatias[t].primeiroVizinho = totalVizinhos;
+        totalVizinhos += fatias[t].vizinhos;
+    }
+    if (totalVizinhos > INT32_MAX) {
+        printf("Erro: Mapa grande demais para o formato (vizinhos demais)!\n");
+        close(arquivo);
+        return 0;
+    }
+    
+    struct CabecalhoMapa cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.assinatura, "WARMAPA1", 8);
+    cabecalho.quantidade = parametros->quantidade;
+    cabecalho.largura = grade.largura;
+    cabecalho.totalRegioes = grade.totalRegioes;
+    cabecalho.tamanhoRegistro = sizeof(struct Territorio);
+    cabecalho.totalVizinhos = totalVizinhos;
+    
+    int ok = escreverNaPosicao(arquivo, &cabecalho, sizeof(cabecalho), 0);
+    
+    executarFatias(fatias, numThreads, escreverFatia);
+    for (int t = 0; t < numThreads; t++) {
+        ok = ok && !fatias[t].erro;
+    }
+    
+    if (close(arquivo) != 0 || !ok) {
+        printf("Erro: Falha ao escrever o arquivo de mapa '%s'!\n", caminho);
+        return 0;
+    }
+    
+    printf("Mapa gerado: %d territórios, %d cores, %d regiões, %lld fronteiras.\n",
+           parametros->quantidade, parametros->cores, grade.totalRegioes, totalVizinhos / 2);
+    return 1;
+}
+
+/*
+ * Função para liberar a adjacência do mapa em jogo
+ */
+void liberarAdjacencia() {
+    free(adjacencia.regiao);
+    free(adjacencia.inicio);
+    free(adjacencia.vizinhos);
+    memset(&adjacencia, 0, sizeof(adjacencia));
+}
+
+/*
+ * Função para carregar um mapa de arquivo
+ * 
+ * Parâmetros:
+ * - caminho: arquivo no formato de CabecalhoMapa
+ * - quantidade: recebe o número de territórios
+ * 
+ * Retorna:
+ * - Ponteiro para o vetor de territórios (alocado com alocarTerritorios)
+ * - NULL em caso de erro (mensagem já exibida)
+ * 
+ * A adjacência e as regiões do arquivo passam a valer para o jogo.
+ */
+struct Territorio* carregarMapa(const char* caminho, int* quantidade) {
+    struct CabecalhoMapa cabecalho;
+    FILE* arquivo = fopen(caminho, "rb");
+    
+    if (arquivo == NULL) {
+        printf("Erro: Não foi possível abrir o arquivo de mapa '%s'!\n", caminho);
+        return NULL;
+    }
+    
+    if (fread(&cabecalho, sizeof(cabecalho), 1, arquivo) != 1 ||
+        memcmp(cabecalho.assinatura, "WARMAPA1", 8) != 0 ||
+        cabecalho.tamanhoRegistro != (int32_t)sizeof(struct Territorio) ||
+        cabecalho.quantidade <= 0 || cabecalho.totalVizinhos < 0 ||
+        cabecalho.totalVizinhos > INT32_MAX) {
+        printf("Erro: '%s' não é um arquivo de mapa válido!\n", caminho);
+        fclose(arquivo);
+        return NULL;
+    }
+    
+    int n = cabecalho.quantidade;
+    struct Territorio* mapa = alocarTerritorios(n);
+    if (mapa == NULL) {
+        fclose(arquivo);
+        return NULL;
+    }
+    
+    liberarAdjacencia();
+    adjacencia.largura = cabecalho.largura;
+    adjacencia.totalRegioes = cabecalho.totalRegioes;
+    adjacencia.regiao = (int32_t*)malloc(n * sizeof(int32_t));
+    adjacencia.inicio = (int32_t*)malloc((n + 1) * sizeof(int32_t));
+    adjacencia.vizinhos = (int32_t*)malloc((cabecalho.totalVizinhos + 1) * sizeof(int32_t));
+    
+    int ok = adjacencia.regiao != NULL && adjacencia.inicio != NULL && adjacencia.vizinhos != NULL &&
+             fread(mapa, sizeof(struct Territorio), n, arquivo) == (size_t)n &&
+             fread(adjacencia.regiao, sizeof(int32_t), n, arquivo) == (size_t)n &&
+             fread(adjacencia.inicio, sizeof(int32_t), n + 1, arquivo) == (size_t)(n + 1) &&
+             fread(adjacencia.vizinhos, sizeof(int32_t), cabecalho.totalVizinhos, arquivo) ==
+                 (size_t)cabecalho.totalVizinhos;
+    fclose(arquivo);
+    
+    // Confere a lista de vizinhos antes de confiar nela
+    for (int i = 0; ok && i < n; i++) {
+        ok = adjacencia.inicio[i] >= 0 && adjacencia.inicio[i] <= adjacencia.inicio[i + 1];
+        mapa[i].nome[sizeof(mapa[i].nome) - 1] = '\0';
+        mapa[i].cor[sizeof(mapa[i].cor) - 1] = '\0';
+    }
+    ok = ok && adjacencia.inicio[n] == cabecalho.totalVizinhos;
+    for (long long k = 0; ok && k < cabecalho.totalVizinhos; k++) {
+        ok = adjacencia.vizinhos[k] >= 0 && adjacencia.vizinhos[k] < n;
+    }
+    
+    if (!ok) {
+        printf("Erro: Arquivo de mapa '%s' incompleto ou corrompido!\n", caminho);
+        liberarAdjacencia();
+        liberarVetorGrande(mapa);
+        return NULL;
+    }
+    
+    adjacencia.ativa = cabecalho.largura > 0;
+    *quantidade = n;
+    printf("Mapa '%s' carregado: %d territórios, %d regiões.\n", caminho, n, cabecalho.totalRegioes);
+    return mapa;
+}
+
+/*
+ * Função para salvar o mapa atual em arquivo
+ * 
+ * Parâmetros:
+ * - caminho: arquivo de saída (formato de CabecalhoMapa)
+ * - mapa: ponteiro para o vetor de territórios
+ * - quantidade: número de territórios
+ * 
+ * Retorna:
+ * - 1 em caso de sucesso
+ * - 0 em caso de erro (mensagem já exibida)
+ * 
+ * A adjacência e as regiões do mapa em jogo são mantidas; um mapa
+ * cadastrado à mão é salvo sem fronteiras.
+ */
+int salvarMapa(const char* caminho, const struct Territorio* mapa, int quantidade) {
+    struct CabecalhoMapa cabecalho;
+    FILE* arquivo = fopen(caminho, "wb");
+    
+    if (arquivo == NULL) {
+        printf("Erro: Não foi possível criar o arquivo de mapa '%s'!\n", caminho);
+        return 0;
+    }
+    
+    int32_t totalVizinhos = adjacencia.ativa ? adjacencia.inicio[quantidade] : 0;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.assinatura, "WARMAPA1", 8);
+    cabecalho.quantidade = quantidade;
+    cabecalho.largura = adjacencia.ativa ? adjacencia.largura : 0;
+    cabecalho.totalRegioes = adjacencia.ativa ? adjacencia.totalRegioes : 1;
+    cabecalho.tamanhoRegistro = sizeof(struct Territorio);
+    cabecalho.totalVizinhos = totalVizinhos;
+    
+    int ok = fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+             fwrite(mapa, sizeof(struct Territorio), quantidade, arquivo) == (size_t)quantidade;
+    
+    if (adjacencia.ativa) {
+        ok = ok &&
+             fwrite(adjacencia.regiao, sizeof(int32_t), quantidade, arquivo) == (size_t)quantidade &&
+             fwrite(adjacencia.inicio, sizeof(int32_t), quantidade + 1, arquivo) == (size_t)(quantidade + 1) &&
+             fwrite(adjacencia.vizinhos, sizeof(int32_t), totalVizinhos, arquivo) == (size_t)totalVizinhos;
+    } else {
+        // Todos na região 0 e listas de vizinhos vazias
+        int32_t zero = 0;
+        for (int i = 0; ok && i < 2 * quantidade + 1; i++) {
+            ok = fwrite(&zero, sizeof(zero), 1, arquivo) == 1;
+        }
+    }
+    
+    if (fclose(arquivo) != 0 || !ok) {
+        printf("Erro: Falha ao escrever o arquivo de mapa '%s'!\n", caminho);
+        return 0;
+    }
+    
+    printf("Mapa salvo em '%s' (%d territórios).\n", caminho, quantidade);
+    return 1;
+}
+
+/*
+ * Definição da estrutura IndiceNomes
+ * 
+ * Tabela de espalhamento (endereçamento aberto) dos nomes dos territórios,
+ * para que comandos por nome custem O(1) mesmo em mapas gerados. Os nomes
+ * não mudam durante o jogo; com nomes repetidos, vale o primeiro.
+ */
+struct IndiceNomes {
+    struct Territorio* mapa;
+    int capacidade;   // Potência de 2, pelo menos o dobro dos territórios
+    int* posicoes;    // Índice do território em cada posição (-1 = vazia)
+};
+
+// Índice de nomes do mapa em jogo
+struct IndiceNomes indiceNomes;
+
+/*
+ * Função de espalhamento FNV-1a de um nome
+ */
+static inline uint32_t espalharNome(const char* nome) {
+    uint32_t h = 2166136261u;
+    while (*nome) {
+        h = (h ^ (unsigned char)*nome++) * 16777619u;
+    }
+    return h;
+}
+
+/*
+ * Função para liberar o índice de nomes
+ */
+void liberarIndiceNomes() {
+    free(indiceNomes.posicoes);
+    memset(&indiceNomes, 0, sizeof(indiceNomes));
+}
+
+/*
+ * Função para construir o índice de nomes de um mapa
+ * 
+ * Retorna:
+ * - 1 em caso de sucesso
+ * - 0 se faltou memória (busca por nome fica indisponível)
+ */
+int construirIndiceNomes(struct Territorio* mapa, int quantidade) {
+    int capacidade = 16;
+    
+    liberarIndiceNomes();
+    while (capacidade < 2 * quantidade) {
+        capacidade *= 2;
+    }
+    
+    indiceNomes.posicoes = (int*)malloc(capacidade * sizeof(int));
+    if (indiceNomes.posicoes == NULL) {
+        return 0;
+    }
+    memset(indiceNomes.posicoes, 0xff, capacidade * sizeof(int));  // Tudo -1
+    indiceNomes.mapa = mapa;
+    indiceNomes.capacidade = capacidade;
+    
+    for (int i = 0; i < quantidade; i++) {
+        uint32_t pos = espalharNome(mapa[i].nome) & (capacidade - 1);
+        while (indiceNomes.posicoes[pos] != -1 &&
+               strcmp(mapa[indiceNomes.posicoes[pos]].nome, mapa[i].nome) != 0) {
+            pos = (pos + 1) & (capacidade - 1);
+        }
+        if (indiceNomes.posicoes[pos] == -1) {
+            indiceNomes.posicoes[pos] = i;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Função para buscar um território pelo nome
+ * 
+ * Retorna:
+ * - Índice do território (0-based)
+ * - -1 se não há território com esse nome
+ */
+int buscarTerritorioPorNome(const char* nome) {
+    if (indiceNomes.posicoes == NULL) {
+        return -1;
+    }
+    
+    uint32_t pos = espalharNome(nome) & (indiceNomes.capacidade - 1);
+    while (indiceNomes.posicoes[pos] != -1) {
+        if (strcmp(indiceNomes.mapa[indiceNomes.posicoes[pos]].nome, nome) == 0) {
+            return indiceNomes.posicoes[pos];
+        }
+        pos = (pos + 1) & (indiceNomes.capacidade - 1);
+    }
+    return -1;
+}
+
+
+/*
+ * Função para exibir todos os territórios usando ponteiros
+ * 
+ * Parâmetros:
+ * - mapa: ponteiro para o vetor de territórios
+ * - quantidade: número de territórios a serem exibidos
+ * 
+ * Mapas gerados podem ter milhões de territórios; só os primeiros
+ * LIMITE_EXIBICAO são listados.
+ */
+void exibirTerritorios(struct Territorio* mapa, int quantidade) {
+    MEDIR_ESCOPO(PONTO_EXIBIR);
+    int exibidos = quantidade < LIMITE_EXIBICAO ? quantidade : LIMITE_EXIBICAO;
+    
+    printf("\n=================================================\n");
+    printf("           MAPA DE TERRITÓRIOS\n");
+    printf("=================================================\n");
+    
+    for (int i = 0; i < exibidos; i++) {
+        printf("\n[%d] Território: %s\n", i + 1, (mapa + i)->nome);
+        printf("    Controlado por: %s\n", (mapa + i)->cor);
+        printf("    Tropas: %d\n", (mapa + i)->tropas);
+    }
+    if (exibidos < quantidade) {
+        printf("\n... e mais %d territórios.\n", quantidade - exibidos);
+    }
+    
+    printf("\n=================================================\n");
+}
+
+/*
+ * Definição da estrutura ExibicaoAssincrona
+ * 
+ * Exibição do mapa em uma thread própria, com dois quadros: a lógica copia
+ * o mapa para o quadro pendente e a thread de exibição troca os quadros e
+ * imprime o seu sem segurar a trava. Só o estado mais recente importa: um
+ * quadro pendente ainda não exibido é substituído (e contado como
+ * descartado) pelo próximo. Cada quadro guarda só as linhas que
+ * exibirTerritorios imprime (LIMITE_EXIBICAO), não o mapa inteiro.
+ */
+struct ExibicaoAssincrona {
+    int ativa;                       // 1 se a thread de exibição está rodando
+    pthread_t thread;                // Thread de exibição
+    pthread_mutex_t trava;           // Protege a troca de quadros
+    pthread_cond_t sinal;            // Avisa a exibição de um quadro novo
+    struct Territorio* pendente;     // Último quadro publicado pela lógica
+    struct Territorio* exibindo;     // Quadro sendo impresso
+    int tamanho;                     // Territórios do mapa
+    int linhas;                      // Territórios copiados por quadro
+    int temPendente;                 // 1 se há quadro publicado não exibido
+    int encerrar;                    // Pedido de encerramento
+    unsigned long long publicados;   // Quadros copiados pela lógica
+    unsigned long long exibidos;     // Quadros impressos
+    unsigned long long descartados;  // Quadros substituídos ou pulados
+};
+
+// Exibição assíncrona do mapa (ligada com --exibicao-assincrona)
+struct ExibicaoAssincrona exibicaoAssincrona;
+int usarExibicaoAssincrona = 0;
+
+/*
+ * Função executada pela thread de exibição
+ */
+void* exibirQuadros(void* argumento) {
+    (void)argumento;
+    
+    pthread_mutex_lock(&exibicaoAssincrona.trava);
+    while (1) {
+        while (!exibicaoAssincrona.temPendente && !exibicaoAssincrona.encerrar) {
+            pthread_cond_wait(&exibicaoAssincrona.sinal, &exibicaoAssincrona.trava);
+        }
+        if (!exibicaoAssincrona.temPendente) {
+            break;  // Encerramento pedido e nada mais a exibir
+        }
+        
+        // Troca os quadros: o pendente passa a ser exibido
+        struct Territorio* quadro = exibicaoAssincrona.pendente;
+        exibicaoAssincrona.pendente = exibicaoAssincrona.exibindo;
+        exibicaoAssincrona.exibindo = quadro;
+        exibicaoAssincrona.temPendente = 0;
+        pthread_mutex_unlock(&exibicaoAssincrona.trava);
+        
+        // Imprime fora da trava; o quadro inteiro sai sem intercalação.
+        // exibirTerritorios só lê as primeiras linhas, que são as copiadas
+        flockfile(stdout);
+        exibirTerritorios(quadro, exibicaoAssincrona.tamanho);
+        fflush(stdout);
+        funlockfile(stdout);
+        
+        pthread_mutex_lock(&exibicaoAssincrona.trava);
+        exibicaoAssincrona.exibidos++;
+    }
+    pthread_mutex_unlock(&exibicaoAssincrona.trava);
+    return NULL;
+}
+
+/*
+ * Função para iniciar a exibição assíncrona
+ * 
+ * Parâmetros:
+ * - quantidade: número de territórios do mapa
+ * 
+ * Retorna:
+ * - 1 se a thread de exibição foi criada
+ * - 0 caso contrário (o jogo segue com exibição direta)
+ */
+int iniciarExibicaoAssincrona(int quantidade) {
+    memset(&exibicaoAssincrona, 0, sizeof(exibicaoAssincrona));
+    exibicaoAssincrona.tamanho = quantidade;
+    exibicaoAssincrona.linhas = quantidade < LIMITE_EXIBICAO ? quantidade : LIMITE_EXIBICAO;
+    exibicaoAssincrona.pendente =
+        (struct Territorio*)malloc(exibicaoAssincrona.linhas * sizeof(struct Territorio));
+    exibicaoAssincrona.exibindo =
+        (struct Territorio*)malloc(exibicaoAssincrona.linhas * sizeof(struct Territorio));
+    
+    if (exibicaoAssincrona.pendente == NULL || exibicaoAssincrona.exibindo == NULL) {
+        free(exibicaoAssincrona.pendente);
+        free(exibicaoAssincrona.exibindo);
+        return 0;
+    }
+    
+    pthread_mutex_init(&exibicaoAssincrona.trava, NULL);
+    pthread_cond_init(&exibicaoAssincrona.sinal, NULL);
+    
+    if (pthread_create(&exibicaoAssincrona.thread, NULL, exibirQuadros, NULL) != 0) {
+        free(exibicaoAssincrona.pendente);
+        free(exibicaoAssincrona.exibindo);
+        return 0;
+    }
+    
+    exibicaoAssincrona.ativa = 1;
+    return 1;
+}
+
+/*
+ * Função para publicar o estado atual do mapa para a exibição
+ * 
+ * Parâmetros:
+ * - mapa: ponteiro para o vetor de territórios
+ * - obrigatorio: 1 garante que este estado será exibido; 0 permite pular o
+ *   quadro se a exibição ainda não consumiu o anterior
+ * 
+ * Sem 'obrigatorio', a lógica nunca espera: se a trava está ocupada ou
+ * ainda há quadro pendente, o quadro é pulado sem custo de cópia.
+ */
+void publicarQuadro(struct Territorio* mapa, int obrigatorio) {
+    if (!exibicaoAssincrona.ativa) {
+        return;
+    }
+    
+    if (obrigatorio) {
+        pthread_mutex_lock(&exibicaoAssincrona.trava);
+    } else if (pthread_mutex_trylock(&exibicaoAssincrona.trava) != 0) {
+        exibicaoAssincrona.descartados++;
+        return;
+    }
+    
+    if (exibicaoAssincrona.temPendente) {
+        exibicaoAssincrona.descartados++;
+        if (!obrigatorio) {
+            pthread_mutex_unlock(&exibicaoAssincrona.trava);
+            return;
+        }
+    }
+    
+    memcpy(exibicaoAssincrona.pendente, mapa, exibicaoAssincrona.linhas * sizeof(struct Territorio));
+    exibicaoAssincrona.temPendente = 1;
+    exibicaoAssincrona.publicados++;
+    pthread_cond_signal(&exibicaoAssincrona.sinal);
+    pthread_mutex_unlock(&exibicaoAssincrona.trava);
+}
+
+/*
+ * Função para encerrar a exibição assíncrona
+ * 
+ * O último quadro publicado ainda é exibido antes de a thread terminar.
+ */
+void encerrarExibicaoAssincrona() {
+    if (!exibicaoAssincrona.ativa) {
+        return;
+    }
+    
+    pthread_mutex_lock(&exibicaoAssincrona.trava);
+    exibicaoAssincrona.encerrar = 1;
+    pthread_cond_signal(&exibicaoAssincrona.sinal);
+    pthread_mutex_unlock(&exibicaoAssincrona.trava);
+    pthread_join(exibicaoAssincrona.thread, NULL);
+    
+    pthread_mutex_destroy(&exibicaoAssincrona.trava);
+    pthread_cond_destroy(&exibicaoAssincrona.sinal);
+    free(exibicaoAssincrona.pendente);
+    free(exibicaoAssincrona.exibindo);
+    exibicaoAssincrona.ativa = 0;
+    
+    printf("Exibição: %llu quadros publicados, %llu exibidos, %llu descartados.\n",
+           exibicaoAssincrona.publicados, exibicaoAssincrona.exibidos,
+           exibicaoAssincrona.descartados);
+}
+
+/*
+ * Função para mostrar o mapa pela exibição assíncrona, se ligada
+ * 
+ * Parâmetros:
+ * - mapa: ponteiro para o vetor de territórios
+ * - quantidade: número de territórios
+ */
+void mostrarMapa(struct Territorio* mapa, int quantidade) {
+    if (exibicaoAssincrona.ativa) {
+        publicarQuadro(mapa, 1);
+    } else {
+        exibirTerritorios(mapa, quantidade);
+    }
+}
+
+/*
+ * Função para identificar um território por número (1 a quantidade) ou nome
+ * 
+ * Retorna:
+ * - Índice do território (0-based)
+ * - -1 se o texto não identifica nenhum território
+ */
+int resolverTerritorio(const char* texto, int quantidade) {
+    char* fim;
+    long numero = strtol(texto, &fim, 10);
+    
+    if (fim != texto && *fim == '\0') {
+        return (numero >= 1 && numero <= quantidade) ? (int)numero - 1 : -1;
+    }
+    return buscarTerritorioPorNome(texto);
+}
+
+/*
+ * Função para selecionar um território para ataque ou defesa
+ * 
+ * Parâmetros:
+ * - mapa: ponteiro para o vetor de territórios
+ * - quantidade: número total de territórios
+ * - acao: string indicando se é para "atacar" ou "defender"
+ * 
+ * Retorna:
+ * - Índice do território selecionado (0-based)
+ * - -1 em caso de seleção inválida
+ */
+int selecionarTerritorio(struct Territorio* mapa, int quantidade, char* acao) {
+    char resposta[sizeof(mapa->nome)];
+    
+    printf("\nSelecione um território para %s (1-%d ou nome): ", acao, quantidade);
+    if (!lerPalavra(resposta, sizeof(resposta))) {
+        return -1;  // Fim da entrada
+    }
+    
+    // Validação da entrada
+    int escolha = resolverTerritorio(resposta, quantidade);
+    if (escolha == -1) {
+        printf("Erro: Seleção inválida! Escolha entre 1 e %d ou o nome de um território.\n", quantidade);
+    }
+    
+    return escolha; // Índice 0-based
+}
+
+/*
+ * Gerador de números aleatórios para os dados de batalha
+ * 
+ * xorshift64*: pequeno, rápido e com estado próprio, o que permite fluxos
+ * independentes e reproduzíveis por semente. Com gerador NULL, os dados
+ * continuam saindo de rand().
+ */
+struct GeradorDados {
+    uint64_t estado;  // Nunca zero
+};
+
+// Gerador usado por atacar (NULL = rand(), como no jogo interativo)
+struct GeradorDados* geradorAtaques = NULL;
+
+// Semente das partidas automáticas (--semente=N; padrão: relógio)
+uint64_t sementePartida = 0;
+
+// 1 suprime as mensagens de atacar e validarAtaque (partidas automáticas)
+int modoSilencioso = 0;
+
+/*
+ * Função para iniciar um gerador a partir de uma semente
+ * 
+ * Parâmetros:
+ * - gerador: ponteiro para o gerador
+ * - semente: qualquer valor (inclusive zero)
+ */
+void iniciarGerador(struct GeradorDados* gerador, uint64_t semente) {
+    // splitmix64 espalha sementes próximas em estados bem diferentes
+    uint64_t z = semente + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    gerador->estado = z ? z : 0x9E3779B97F4A7C15ULL;
+}
+
+/*
+ * Função para sortear o próximo número de 64 bits do gerador
+ */
+uint64_t proximoAleatorio(struct GeradorDados* gerador) {
+    uint64_t x = gerador->estado;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    gerador->estado = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+/*
+ * Função para rolar um dado de 6 faces
+ * 
+ * Parâmetros:
+ * - gerador: gerador a usar (NULL = rand())
+ * 
+ * Retorna:
+ * - Valor entre 1 e 6
+ */
+int rolarDado(struct GeradorDados* gerador) {
+    if (gerador == NULL) {
+        return rand() % 6 + 1;
+    }
+    // Multiplicação em vez de módulo: 32 bits altos escalados para 0..5
+    return (int)(((proximoAleatorio(gerador) >> 32) * 6) >> 32) + 1;
+}
+
+// Regras de combate disponíveis
+#define COMBATE_DADO_UNICO 0  // Um dado para cada lado, metade das tropas avança
+#define COMBATE_CLASSICO 1    // Até 3 dados contra 3, perdas comparadas por par
+
+// Regra de combate em uso
+int modoCombate = COMBATE_DADO_UNICO;
+
+/*
+ * Definição da estrutura ResultadoBatalha
+ * 
+ * Registro completo de um ataque, usado para exibir o resultado:
+ * - dadosAtaque/dadosDefesa: dados em ordem decrescente (0 = não rolado)
+ * - perdasAtaque/perdasDefesa: tropas perdidas por cada lado
+ * - conquistou: 1 se o defensor mudou de dono
+ * - tropasMovidas: tropas que avançaram para o território conquistado
+ */
+struct ResultadoBatalha {
+    int dadosAtaque[3];
+    int dadosDefesa[3];
+    int numDadosAtaque;
+    int numDadosDefesa;
+    int perdasAtaque;
+    int perdasDefesa;
+    int conquistou;
+    int tropasMovidas;
+};
+
+/*
+ * Função para ordenar três dados em ordem decrescente sem desvios
+ * 
+ * Parâmetros:
+ * - d: vetor com três dados
+ * 
+ * Rede de ordenação de 3 comparadores; cada troca é feita com aritmética
+ * e máscaras, sem if, para não depender da previsão de desvios.
+ */
+static inline void ordenarTresDados(int* d) {
+    int delta;
+    
+    delta = (d[0] - d[1]) & -(d[0] < d[1]);
+    d[0] -= delta; d[1] += delta;
+    delta = (d[1] - d[2]) & -(d[1] < d[2]);
+    d[1] -= delta; d[2] += delta;
+    delta = (d[0] - d[1]) & -(d[0] < d[1]);
+    d[0] -= delta; d[1] += delta;
+}
+
+/*
+ * Função para resolver um ataque sem exibir nada na tela
+ * 
+ * Parâmetros:
+ * - atacante: ponteiro para o território atacante
+ * - defensor: ponteiro para o território defensor
+ * - gerador: gerador dos dados (NULL = rand())
+ * - resultado: ponteiro para a estrutura que recebe o registro do ataque
+ * 
+ * Aplica a regra de combate de modoCombate aos dois territórios. Não toca
+ * em nenhum estado global além do gerador, então ataques a territórios
+ * diferentes podem ser resolvidos ao mesmo tempo com geradores próprios.
+ */
+void resolverBatalha(struct Territorio* atacante, struct Territorio* defensor,
+                     struct GeradorDados* gerador, struct ResultadoBatalha* resultado) {
+    memset(resultado, 0, sizeof(*resultado));
+    
+    if (modoCombate == COMBATE_DADO_UNICO) {
+        resultado->dadosAtaque[0] = rolarDado(gerador);
+        resultado->dadosDefesa[0] = rolarDado(gerador);
+        resultado->numDadosAtaque = 1;
+        resultado->numDadosDefesa = 1;
+        
+        if (resultado->dadosAtaque[0] > resultado->dadosDefesa[0]) {
+            // Atacante vence: o defensor muda de dono e recebe metade das tropas
+            strcpy(defensor->cor, atacante->cor);
+            resultado->perdasDefesa = defensor->tropas;
+            resultado->tropasMovidas = atacante->tropas / 2;
+            resultado->conquistou = 1;
+            defensor->tropas = resultado->tropasMovidas;
+            atacante->tropas -= resultado->tropasMovidas;
+        } else if (atacante->tropas > 1) {
+            // Defensor vence: o atacante perde uma tropa (mínimo: 1)
+            resultado->perdasAtaque = 1;
+            atacante->tropas--;
+        }
+        return;
+    }
+    
+    // Regra clássica: o atacante deixa 1 tropa para trás, o defensor usa todas
+    int na = atacante->tropas - 1;
+    int nd = defensor->tropas;
+    na = na > 3 ? 3 : na;
+    nd = nd > 3 ? 3 : nd;
+    nd = nd < 0 ? 0 : nd;
+    if (na < 1) {
+        return;
+    }
+    
+    // Rola sempre três dados e zera os que não existem: sem desvios
+    for (int i = 0; i < 3; i++) {
+        resultado->dadosAtaque[i] = rolarDado(gerador) & -(i < na);
+        resultado->dadosDefesa[i] = rolarDado(gerador) & -(i < nd);
+    }
+    ordenarTresDados(resultado->dadosAtaque);
+    ordenarTresDados(resultado->dadosDefesa);
+    
+    // Compara os pares maior com maior; empate favorece o defensor
+    int pares = nd + ((na - nd) & -(na < nd));
+    for (int i = 0; i < 3; i++) {
+        int valido = i < pares;
+        int ataqueVence = resultado->dadosAtaque[i] > resultado->dadosDefesa[i];
+        resultado->perdasDefesa += valido & ataqueVence;
+        resultado->perdasAtaque += valido & !ataqueVence;
+    }
+    
+    resultado->numDadosAtaque = na;
+    resultado->numDadosDefesa = nd;
+    atacante->tropas -= resultado->perdasAtaque;
+    defensor->tropas -= resultado->perdasDefesa;
+    
+    if (defensor->tropas <= 0) {
+        // Território conquistado: avançam tantas tropas quanto dados de ataque
+        int movidas = na < atacante->tropas - 1 ? na : atacante->tropas - 1;
+        strcpy(defensor->cor, atacante->cor);
+        resultado->conquistou = 1;
+        resultado->tropasMovidas = movidas;
+        defensor->tropas = movidas;
+        atacante->tropas -= movidas;
+    }
+}
+
+/*
+ * Função para exibir uma lista de dados já ordenados
+ */
+void exibirDados(const int* dados, int quantidade) {
+    for (int i = 0; i < quantidade; i++) {
+        printf("%s%d", i ? " " : "", dados[i]);
+    }
+}
+
+/*
+ * Definição da estrutura EventoBatalha
+ * 
+ * Registro de tamanho fixo (64 bytes, sem preenchimento) de um ataque,
+ * gravado como está no formato binário do fluxo de eventos:
+ * - sequencia: número do evento desde o início da partida
+ * - atacante/defensor: índices no mapa (-1 se fora do mapa indexado)
+ * - tropas*: tropas de cada território após o ataque
+ * - dados*: dados em ordem decrescente (0 = não rolado)
+ */
+struct EventoBatalha {
+    uint64_t sequencia;
+    int32_t atacante;
+    int32_t defensor;
+    int32_t tropasAtacante;
+    int32_t tropasDefensor;
+    int32_t perdasAtaque;
+    int32_t perdasDefesa;
+    int32_t tropasMovidas;
+    int8_t dadosAtaque[3];
+    int8_t dadosDefesa[3];
+    int8_t conquistou;
+    int8_t modoCombate;
+    char corAtacante[10];
+    char corDefensor[10];
+};
+
+_Static_assert(sizeof(struct EventoBatalha) == 64, "EventoBatalha deve ter 64 bytes");
+
+// Capacidade do anel de eventos (potência de 2)
+#define CAPACIDADE_EVENTOS 8192
+
+/*
+ * Definição da estrutura FluxoEventos
+ * 
+ * Anel sem travas de um produtor (a thread do jogo) e um consumidor (a
+ * thread escritora). O produtor só copia o evento para o anel; formatação
+ * e escrita ficam com o escritor. Com o anel cheio o evento é descartado
+ * e contado, para que o ataque nunca espere pelo disco.
+ * 
+ * Com o anel vazio o escritor dorme na variável de condição. O produtor só
+ * toca na trava quando vê o escritor dormindo: o escritor marca dormindo
+ * antes de reler a cabeça, e o produtor publica a cabeça antes de ler
+ * dormindo, então um dos dois sempre vê o outro.
+ */
+struct FluxoEventos {
+    int ativo;                       // 1 se o fluxo está ligado
+    int binario;                     // 1 = binário, 0 = NDJSON
+    FILE* arquivo;                   // Destino (arquivo ou pipe)
+    pthread_t escritor;              // Thread que drena o anel
+    _Atomic int encerrar;            // Pedido de encerramento do escritor
+    _Atomic uint64_t cabeca;         // Próxima posição a escrever (produtor)
+    _Atomic uint64_t cauda;          // Próxima posição a ler (consumidor)
+    _Atomic uint64_t descartados;    // Eventos perdidos com o anel cheio
+    _Atomic int dormindo;            // 1 enquanto o escritor espera eventos
+    pthread_mutex_t trava;           // Protege a espera do escritor
+    pthread_cond_t novoEvento;       // Acorda o escritor
+    uint64_t sequencia;              // Contador de eventos do produtor
+    uint64_t escritos;               // Eventos gravados pelo escritor
+    struct EventoBatalha anel[CAPACIDADE_EVENTOS];
+};
+
+// Fluxo global de eventos de batalha
+struct FluxoEventos fluxoEventos;
+
+// Caminho e formato pedidos na linha de comando (NULL = desligado)
+char* caminhoEventos = NULL;
+int eventosBinarios = 0;
+
+/*
+ * Função para escrever uma string JSON com escape de aspas e barras
+ */
+void escreverTextoJson(FILE* arquivo, const char* texto) {
+    fputc('"', arquivo);
+    for (const char* p = texto; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', arquivo);
+            fputc(*p, arquivo);
+        } else if ((unsigned char)*p < 0x20) {
+            fprintf(arquivo, "\\u%04x", *p);
+        } else {
+            fputc(*p, arquivo);
+        }
+    }
+    fputc('"', arquivo);
+}
+
+/*
+ * Função para escrever um evento como uma linha NDJSON
+ */
+void escreverEventoJson(FILE* arquivo, const struct EventoBatalha* evento) {
+    fprintf(arquivo, "{\"seq\":%llu,\"atacante\":%d,\"defensor\":%d,\"cor_atacante\":",
+            (unsigned long long)evento->sequencia, evento->atacante, evento->defensor);
+    escreverTextoJson(arquivo, evento->corAtacante);
+    fputs(",\"cor_defensor\":", arquivo);
+    escreverTextoJson(arquivo, evento->corDefensor);
+    
+    fputs(",\"dados_ataque\":[", arquivo);
+    for (int i = 0; i < 3 && evento->dadosAtaque[i]; i++) {
+        fprintf(arquivo, "%s%d", i ? "," : "", evento->dadosAtaque[i]);
+    }
+    fputs("],\"dados_defesa\":[", arquivo);
+    for (int i = 0; i < 3 && evento->dadosDefesa[i]; i++) {
+        fprintf(arquivo, "%s%d", i ? "," : "", evento->dadosDefesa[i]);
+    }
+    
+    fprintf(arquivo, "],\"perdas_ataque\":%d,\"perdas_defesa\":%d,\"tropas_movidas\":%d,"
+            "\"conquista\":%s,\"tropas_atacante\":%d,\"tropas_defensor\":%d,\"combate\":\"%s\"}\n",
+            evento->perdasAtaque, evento->perdasDefesa, evento->tropasMovidas,
+            evento->conquistou ? "true" : "false", evento->tropasAtacante, evento->tropasDefensor,
+            evento->modoCombate == COMBATE_CLASSICO ? "classico" : "unico");
+}
+
+/*
+ * Função executada pela thread escritora do fluxo de eventos
+ * 
+ * Drena o anel em lotes e só dorme quando não há nada para escrever,
+ * até que o produtor publique um evento ou peça o encerramento.
+ */
+void* escreverEventos(void* argumento) {
+    (void)argumento;
+    
+    while (1) {
+        uint64_t cauda = atomic_load_explicit(&fluxoEventos.cauda, memory_order_relaxed);
+        uint64_t cabeca = atomic_load_explicit(&fluxoEventos.cabeca, memory_order_acquire);
+        
+        if (cauda == cabeca) {
+            if (atomic_load(&fluxoEventos.encerrar)) {
+                break;  // Encerramento pedido e anel vazio
+            }
+            fflush(fluxoEventos.arquivo);
+            
+            pthread_mutex_lock(&fluxoEventos.trava);
+            atomic_store(&fluxoEventos.dormindo, 1);
+            while (atomic_load(&fluxoEventos.cabeca) == cauda && !atomic_load(&fluxoEventos.encerrar)) {
+                pthread_cond_wait(&fluxoEventos.novoEvento, &fluxoEventos.trava);
+            }
+            atomic_store(&fluxoEventos.dormindo, 0);
+            pthread_mutex_unlock(&fluxoEventos.trava);
+            continue;
+        }
+        
+        for (; cauda != cabeca; cauda++) {
+            const struct EventoBatalha* evento = &fluxoEventos.anel[cauda & (CAPACIDADE_EVENTOS - 1)];
+            if (fluxoEventos.binario) {
+                fwrite(evento, sizeof(*evento), 1, fluxoEventos.arquivo);
+            } else {
+                escreverEventoJson(fluxoEventos.arquivo, evento);
+            }
+            fluxoEventos.escritos++;
+        }
+        
+        // Libera as posições lidas para o produtor
+        atomic_store_explicit(&fluxoEventos.cauda, cauda, memory_order_release);
+    }
+    
+    fflush(fluxoEventos.arquivo);
+    return NULL;
+}
+
+/*
+ * Função para acordar o escritor se ele estiver esperando eventos
+ */
+void acordarEscritor() {
+    if (atomic_load(&fluxoEventos.dormindo)) {
+        pthread_mutex_lock(&fluxoEventos.trava);
+        pthread_cond_signal(&fluxoEventos.novoEvento);
+        pthread_mutex_unlock(&fluxoEventos.trava);
+    }
+}
+
+/*
+ * Função para encerrar o fluxo de eventos (registrada com atexit)
+ * 
+ * Espera o escritor gravar o que resta no anel e exibe os contadores.
+ */
+void encerrarFluxoEventos(void) {
+    if (!fluxoEventos.ativo) {
+        return;
+    }
+    
+    atomic_store(&fluxoEventos.encerrar, 1);
+    acordarEscritor();
+    pthread_join(fluxoEventos.escritor, NULL);
+    
+    fclose(fluxoEventos.arquivo);
+    fluxoEventos.ativo = 0;
+    
+    fprintf(stderr, "Fluxo de eventos: %llu gravados, %llu descartados (anel cheio).\n",
+            (unsigned long long)fluxoEventos.escritos,
+            (unsigned long long)atomic_load(&fluxoEventos.descartados));
+}
+
+/*
+ * Função para iniciar o fluxo de eventos de batalha
+ * 
+ * Parâmetros:
+ * - caminho: arquivo ou pipe de destino ("-" = saída padrão)
+ * - binario: 1 para registros binários, 0 para NDJSON
+ * 
+ * Com "-", os eventos ficam com a saída padrão original e o jogo passa a
+ * escrever na saída de erro, para que o NDJSON não se misture com o mapa
+ * e as mensagens do jogo.
+ * 
+ * Retorna:
+ * - 1 se o fluxo foi iniciado
+ * - 0 em caso de erro (mensagem já exibida)
+ */
+int iniciarFluxoEventos(const char* caminho, int binario) {
+    FILE* arquivo;
+    
+    if (strcmp(caminho, "-") == 0) {
+        fflush(stdout);
+        int descritor = dup(STDOUT_FILENO);
+        arquivo = descritor < 0 ? NULL : fdopen(descritor, binario ? "wb" : "w");
+        if (arquivo != NULL) {
+            dup2(STDERR_FILENO, STDOUT_FILENO);
+        } else if (descritor >= 0) {
+            close(descritor);
+        }
+    } else {
+        arquivo = fopen(caminho, binario ? "wb" : "w");
+    }
+    
+    if (arquivo == NULL) {
+        printf("Erro: Não foi possível abrir '%s' para os eventos de batalha!\n", caminho);
+        return 0;
+    }
+    
+    fluxoEventos.arquivo = arquivo;
+    fluxoEventos.binario = binario;
+    atomic_store(&fluxoEventos.encerrar, 0);
+    atomic_store(&fluxoEventos.cabeca, 0);
+    atomic_store(&fluxoEventos.cauda, 0);
+    atomic_store(&fluxoEventos.descartados, 0);
+    atomic_store(&fluxoEventos.dormindo, 0);
+    pthread_mutex_init(&fluxoEventos.trava, NULL);
+    pthread_cond_init(&fluxoEventos.novoEvento, NULL);
+    fluxoEventos.sequencia = 0;
+    fluxoEventos.escritos = 0;
+    
+    if (binario) {
+        // Cabeçalho: assinatura e tamanho do registro
+        static const char assinatura[8] = "WAREVT1";
+        uint32_t tamanhoRegistro = sizeof(struct EventoBatalha);
+        fwrite(assinatura, sizeof(assinatura), 1, arquivo);
+        fwrite(&tamanhoRegistro, sizeof(tamanhoRegistro), 1, arquivo);
+    }
+    
+    if (pthread_create(&fluxoEventos.escritor, NULL, escreverEventos, NULL) != 0) {
+        printf("Erro: Não foi possível criar a thread de eventos!\n");
+        fclose(arquivo);
+        return 0;
+    }
+    
+    fluxoEventos.ativo = 1;
+    atexit(encerrarFluxoEventos);
+    return 1;
+}
+
+/*
+ * Função para publicar o resultado de um ataque no fluxo de eventos
+ * 
+ * Parâmetros:
+ * - atacante, defensor: territórios após o ataque
+ * - corAtacante, corDefensor: cores antes do ataque
+ * - resultado: registro do ataque
+ * 
+ * Só copia o evento para o anel e nunca formata texto; só toca na trava
+ * do escritor quando ele está dormindo com o anel vazio.
+ */
+void publicarEventoBatalha(struct Territorio* atacante, struct Territorio* defensor,
+                           const char* corAtacante, const char* corDefensor,
+                           const struct ResultadoBatalha* resultado) {
+    if (!fluxoEventos.ativo) {
+        return;
+    }
+    
+    uint64_t cabeca = atomic_load_explicit(&fluxoEventos.cabeca, memory_order_relaxed);
+    uint64_t cauda = atomic_load_explicit(&fluxoEventos.cauda, memory_order_acquire);
+    uint64_t sequencia = ++fluxoEventos.sequencia;
+    
+    if (cabeca - cauda == CAPACIDADE_EVENTOS) {
+        atomic_fetch_add_explicit(&fluxoEventos.descartados, 1, memory_order_relaxed);
+        return;
+    }
+    
+    struct EventoBatalha* evento = &fluxoEventos.anel[cabeca & (CAPACIDADE_EVENTOS - 1)];
+    evento->sequencia = sequencia;
+    evento->atacante = indiceNoMapa(atacante);
+    evento->defensor = indiceNoMapa(defensor);
+    evento->tropasAtacante = atacante->tropas;
+    evento->tropasDefensor = defensor->tropas;
+    evento->perdasAtaque = resultado->perdasAtaque;
+    evento->perdasDefesa = resultado->perdasDefesa;
+    evento->tropasMovidas = resultado->tropasMovidas;
+    for (int i = 0; i < 3; i++) {
+        evento->dadosAtaque[i] = (int8_t)resultado->dadosAtaque[i];
+        evento->dadosDefesa[i] = (int8_t)resultado->dadosDefesa[i];
+    }
+    evento->conquistou = (int8_t)resultado->conquistou;
+    evento->modoCombate = (int8_t)modoCombate;
+    memcpy(evento->corAtacante, corAtacante, sizeof(evento->corAtacante));
+    memcpy(evento->corDefensor, corDefensor, sizeof(evento->corDefensor));
+    
+    // Publica o evento para o escritor (ordem total com dormindo)
+    atomic_store(&fluxoEventos.cabeca, cabeca + 1);
+    acordarEscritor();
+}
+
+/*
+ * Função para exibir o resultado de um ataque
+ * 
+ * Parâmetros:
+ * - atacante, defensor: territórios após o ataque
+ * - nomeAtacante, corAtacante, corDefensor: dados anteriores ao ataque
+ * - resultado: registro do ataque
+ */
+void exibirResultadoBatalha(struct Territorio* atacante, struct Territorio* defensor,
+                            const char* nomeAtacante, const char* corAtacante,
+                            const char* corDefensor, const struct ResultadoBatalha* resultado) {
+    printf("\n=================================================\n");
+    printf("                SIMULAÇÃO DE BATALHA\n");
+    printf("=================================================\n");
+    
+    if (modoCombate == COMBATE_DADO_UNICO) {
+        printf("Atacante: %s (%s) - Dado: %d\n", nomeAtacante, corAtacante, resultado->dadosAtaque[0]);
+        printf("Defensor: %s (%s) - Dado: %d\n", defensor->nome, corDefensor, resultado->dadosDefesa[0]);
+    } else {
+        printf("Atacante: %s (%s) - Dados: ", nomeAtacante, corAtacante);
+        exibirDados(resultado->dadosAtaque, resultado->numDadosAtaque);
+        printf("\nDefensor: %s (%s) - Dados: ", defensor->nome, corDefensor);
+        exibirDados(resultado->dadosDefesa, resultado->numDadosDefesa);
+        printf("\n");
+    }
+    printf("-------------------------------------------------\n");
+    
+    if (modoCombate == COMBATE_CLASSICO) {
+        printf("Perdas do atacante: %d | Perdas do defensor: %d\n",
+               resultado->perdasAtaque, resultado->perdasDefesa);
+    }
+    
+    if (resultado->conquistou) {
+        // Atacante vence
+        printf("VITÓRIA DO ATACANTE!\n");
+        printf("Território '%s' foi conquistado por %s!\n", defensor->nome, atacante->cor);
+        printf("Tropas transferidas: %d\n", resultado->tropasMovidas);
+        printf("Tropas restantes do atacante: %d\n", atacante->tropas);
+        
+    } else if (modoCombate == COMBATE_CLASSICO) {
+        printf("Território '%s' resistiu ao ataque com %d tropas.\n", defensor->nome, defensor->tropas);
+        printf("Tropas restantes do atacante: %d\n", atacante->tropas);
+        
+    } else {
+        // Defensor vence
+        printf("VITÓRIA DO DEFENSOR!\n");
+        printf("Território '%s' resistiu ao ataque!\n", defensor->nome);
+        
+        if (resultado->perdasAtaque > 0) {
+            printf("O atacante perdeu 1 tropa. Tropas restantes: %d\n", atacante->tropas);
+        } else {
+            printf("O atacante não pode perder mais tropas (mínimo: 1).\n");
+        }
+    }
+    
+    printf("=================================================\n");
+}
+
+/*
+ * Função para simular um ataque entre territórios
+ * 
+ * Parâmetros:
+ * - atacante: ponteiro para o território atacante
+ * - defensor: ponteiro para o território defensor
+ * 
+ * Lógica (regra de dado único, padrão):
+ * - Simula rolagem de dados (1-6) para atacante e defensor
+ * - Se atacante vencer: defensor muda de cor e recebe metade das tropas
+ * - Se defensor vencer: atacante perde uma tropa
+ * 
+ * Na regra clássica, cada lado rola até 3 dados e as perdas são
+ * contadas par a par (ver resolverBatalha).
+ */
+void atacar(struct Territorio* atacante, struct Territorio* defensor) {
+    MEDIR_ESCOPO(PONTO_ATACAR);
+    struct ResultadoBatalha resultado;
+    char nomeAtacante[30], corAtacante[10], corDefensor[10];
+    
+    // Guarda os dados exibidos antes que a batalha altere os territórios
+    strcpy(nomeAtacante, atacante->nome);
+    strcpy(corAtacante, atacante->cor);
+    strcpy(corDefensor, defensor->cor);
+    
+    resolverBatalha(atacante, defensor, geradorAtaques, &resultado);
+    
+    if (!modoSilencioso) {
+        exibirResultadoBatalha(atacante, defensor, nomeAtacante, corAtacante, corDefensor, &resultado);
+    }
+    
+    // Manter o índice de alvos em dia com as tropas e donos atuais
+    atualizarIndiceAlvos(atacante);
+    atualizarIndiceAlvos(defensor);
+    
+    publicarEventoBatalha(atacante, defensor, corAtacante, corDefensor, &resultado);
+}
+
+// Motivos de rejeição de um ataque (ver motivoRejeicao)
+#define ATAQUE_VALIDO 0
+#define ATAQUE_MESMO_TERRITORIO 1
+#define ATAQUE_ALIADOS 2
+#define ATAQUE_SEM_TROPAS 3
+#define ATAQUE_SEM_FRONTEIRA 4
+
+/*
+ * Função com as regras de validação de um ataque, sem mensagens
+ * 
+ * Parâmetros:
+ * - atacante, defensor: territórios envolvidos
+ * - indiceAtacante, indiceDefensor: posições no mapa (-1 = desconhecida;
+ *   a fronteira só é conferida com as duas posições)
+ * 
+ * Retorna:
+ * - ATAQUE_VALIDO ou o primeiro motivo de rejeição encontrado
+ * 
+ * Usada por validarAtaque e pelas ramificações do mapa, que guardam
+ * cópias dos territórios e por isso não podem ser localizadas pelo ponteiro.
+ */
+int motivoRejeicao(const struct Territorio* atacante, const struct Territorio* defensor,
+                   int indiceAtacante, int indiceDefensor) {
+    // Verificar se são territórios diferentes
+    if (atacante == defensor || (indiceAtacante != -1 && indiceAtacante == indiceDefensor)) {
+        return ATAQUE_MESMO_TERRITORIO;
+    }
+    
+    // Verificar se são da mesma cor (aliados)
+    if (strcmp(atacante->cor, defensor->cor) == 0) {
+        return ATAQUE_ALIADOS;
+    }
+    
+    // Verificar se o atacante tem tropas suficientes
+    if (atacante->tropas < 2) {
+        return ATAQUE_SEM_TROPAS;
+    }
+    
+    // Verificar se fazem fronteira (só em mapas com adjacência)
+    if (indiceAtacante != -1 && indiceDefensor != -1 && !fazemFronteira(indiceAtacante, indiceDefensor)) {
+        return ATAQUE_SEM_FRONTEIRA;
+    }
+    
+    return ATAQUE_VALIDO;
+}
+
+/*
+ * Função para validar se um ataque é permitido
+ * 
+ * Parâmetros:
+ * - atacante: ponteiro para o território atacante
+ * - defensor: ponteiro para o território defensor
+ * 
+ * Retorna:
+ * - 1 se o ataque é válido
+ * - 0 se o ataque não é permitido
+ */
+int validarAtaque(struct Territorio* atacante, struct Territorio* defensor) {
+    MEDIR_ESCOPO(PONTO_VALIDAR);
+    
+    switch (motivoRejeicao(atacante, defensor, indiceNoMapa(atacante), indiceNoMapa(defensor))) {
+        case ATAQUE_MESMO_TERRITORIO:
+            if (!modoSilencioso) printf("Erro: Um território não pode atacar a si mesmo!\n");
+            CONTAR(REJEICAO_MESMO_TERRITORIO);
+            return 0;
+        case ATAQUE_ALIADOS:
+            if (!modoSilencioso) printf("Erro: Territórios aliados (%s) não podem se atacar!\n", atacante->cor);
+            CONTAR(REJEICAO_ALIADOS);
+            return 0;
+        case ATAQUE_SEM_TROPAS:
+            if (!modoSilencioso) printf("Erro: O atacante precisa ter pelo menos 2 tropas para atacar!\n");
+            CONTAR(REJEICAO_TROPAS);
+            return 0;
+        case ATAQUE_SEM_FRONTEIRA:
+            if (!modoSilencioso) printf("Erro: %s não faz fronteira com %s!\n", atacante->nome, defensor->nome);
+            CONTAR(REJEICAO_FRONTEIRA);
+            return 0;
+    }
+    
+    return 1; // Ataque válido
+}
+
+/*
+ * Definição da estrutura RamificacaoMapa
+ * 
+ * Cópia preguiçosa (copy-on-write) de um estado do jogo para análises do
+ * tipo "e se": a ramificação lê os territórios do mapa de origem e só
+ * copia para a sua tabela os que ela altera. A memória cresce com o número
+ * de territórios alterados, não com o tamanho do mapa. O mapa de origem
+ * não pode mudar enquanto houver ramificações dele; como ele só é lido,
+ * várias ramificações podem ser usadas em threads diferentes ao mesmo tempo.
+ */
+struct EntradaRamificacao {
+    int indice;                    // Território copiado (-1 = posição vazia)
+    struct Territorio territorio;  // Estado do território nesta ramificação
+};
+
+struct RamificacaoMapa {
+    const struct Territorio* base;         // Mapa de origem (somente leitura)
+    int tamanho;                           // Territórios do mapa
+    int capacidade;                        // Posições da tabela (potência de 2)
+    int alterados;                         // Territórios copiados
+    struct EntradaRamificacao* entradas;   // Tabela de espalhamento dos copiados
+};
+
+// Posições iniciais da tabela de uma ramificação
+#define CAPACIDADE_INICIAL_RAMIFICACAO 8
+
+/*
+ * Função para calcular a posição inicial de um território na tabela
+ */
+static inline int posicaoNaRamificacao(int indice, int capacidade) {
+    return (int)(((uint32_t)indice * 2654435761u) & (uint32_t)(capacidade - 1));
+}
+
+/*
+ * Função para criar uma ramificação de um mapa
+ * 
+ * Parâmetros:
+ * - ramificacao: estrutura a iniciar
+ * - base: mapa de origem
+ * - tamanho: número de territórios
+ * 
+ * Retorna:
+ * - 1 em caso de sucesso
+ * - 0 se faltou memória
+ */
+int iniciarRamificacao(struct RamificacaoMapa* ramificacao, const struct Territorio* base, int tamanho) {
+    ramificacao->base = base;
+    ramificacao->tamanho = tamanho;
+    ramificacao->capacidade = CAPACIDADE_INICIAL_RAMIFICACAO;
+    ramificacao->alterados = 0;
+    ramificacao->entradas = (struct EntradaRamificacao*)malloc(
+        CAPACIDADE_INICIAL_RAMIFICACAO * sizeof(struct EntradaRamificacao));
+    
+    if (ramificacao->entradas == NULL) {
+        return 0;
+    }
+    for (int p = 0; p < CAPACIDADE_INICIAL_RAMIFICACAO; p++) {
+        ramificacao->entradas[p].indice = -1;
+    }
+    return 1;
+}
+
+/*
+ * Função para liberar uma ramificação
+ */
+void liberarRamificacao(struct RamificacaoMapa* ramificacao) {
+    free(ramificacao->entradas);
+    ramificacao->entradas = NULL;
+    ramificacao->capacidade = ramificacao->alterados = 0;
+}
+
+/*
+ * Função para ler um território como ele está na ramificação
+ * 
+ * Retorna:
+ * - Ponteiro para a cópia da ramificação, se o território foi alterado,
+ *   ou para o território do mapa de origem
+ */
+const struct Territorio* territorioNaRamificacao(const struct RamificacaoMapa* ramificacao, int indice) {
+    int mascara = ramificacao->capacidade - 1;
+    
+    for (int p = posicaoNaRamificacao(indice, ramificacao->capacidade);
+         ramificacao->entradas[p].indice != -1; p = (p + 1) & mascara) {
+        if (ramificacao->entradas[p].indice == indice) {
+            return &ramificacao->entradas[p].territorio;
+        }
+    }
+    return &ramificacao->base[indice];
+}
+
+/*
+ * Função para garantir espaço para mais territórios alterados
+ * 
+ * Parâmetros:
+ * - ramificacao: ramificação a ampliar
+ * - novos: territórios que ainda serão copiados
+ * 
+ * Retorna:
+ * - 1 em caso de sucesso
+ * - 0 se faltou memória (a ramificação continua válida)
+ * 
+ * A tabela é mantida no máximo meio cheia. Ampliá-la move as cópias, o que
+ * invalida os ponteiros devolvidos antes por alterarNaRamificacao.
+ */
+int reservarRamificacao(struct RamificacaoMapa* ramificacao, int novos) {
+    int capacidade = ramificacao->capacidade;
+    while (2 * (ramificacao->alterados + novos) > capacidade) {
+        capacidade *= 2;
+    }
+    if (capacidade == ramificacao->capacidade) {
+        return 1;
+    }
+    
+    struct EntradaRamificacao* entradas =
+        (struct EntradaRamificacao*)malloc(capacidade * sizeof(struct EntradaRamificacao));
+    if (entradas == NULL) {
+        return 0;
+    }
+    for (int p = 0; p < capacidade; p++) {
+        entradas[p].indice = -1;
+    }
+    
+    for (int q = 0; q < ramificacao->capacidade; q++) {
+        if (ramificacao->entradas[q].indice != -1) {
+            int p = posicaoNaRamificacao(ramificacao->entradas[q].indice, capacidade);
+            while (entradas[p].indice != -1) {
+                p = (p + 1) & (capacidade - 1);
+            }
+            entradas[p] = ramificacao->entradas[q];
+        }
+    }
+    
+    free(ramificacao->entradas);
+    ramificacao->entradas = entradas;
+    ramificacao->capacidade = capacidade;
+    return 1;
+}
+
+/*
+ * Função para obter um território da ramificação para alteração
+ * 
+ * Retorna:
+ * - Ponteiro para a cópia do território nesta ramificação (copiado do
+ *   mapa de origem na primeira alteração)
+ * - NULL se faltou memória
+ */
+struct Territorio* alterarNaRamificacao(struct RamificacaoMapa* ramificacao, int indice) {
+    if (!reservarRamificacao(ramificacao, 1)) {
+        return NULL;
+    }
+    
+    int mascara = ramificacao->capacidade - 1;
+    int p = posicaoNaRamificacao(indice, ramificacao->capacidade);
+    while (ramificacao->entradas[p].indice != -1) {
+        if (ramificacao->entradas[p].indice == indice) {
+            return &ramificacao->entradas[p].territorio;
+        }
+        p = (p + 1) & mascara;
+    }
+    
+    ramificacao->entradas[p].indice = indice;
+    ramificacao->entradas[p].territorio = ramificacao->base[indice];
+    ramificacao->alterados++;
+    return &ramificacao->entradas[p].territorio;
+}
+
+/*
+ * Função para calcular a memória usada por uma ramificação
+ */
+size_t memoriaRamificacao(const struct RamificacaoMapa* ramificacao) {
+    return sizeof(*ramificacao) + ramificacao->capacidade * sizeof(struct EntradaRamificacao);
+}
+
+/*
+ * Função para realizar um ataque dentro de uma ramificação
+ * 
+ * Parâmetros:
+ * - ramificacao: estado do jogo onde o ataque acontece
+ * - atacante, defensor: índices dos territórios
+ * - gerador: gerador de dados próprio da thread que usa a ramificação
+ * - resultado: ponteiro para os dados e perdas da batalha
+ * 
+ * Retorna:
+ * - ATAQUE_VALIDO se o ataque aconteceu
+ * - O motivo da rejeição, com as mesmas regras de validarAtaque
+ * - -1 se faltou memória
+ * 
+ * Usa a mesma resolução de batalha do jogo, sem mensagens, sem índice de
+ * alvos e sem eventos: o mapa em jogo não é tocado.
+ */
+int atacarNaRamificacao(struct RamificacaoMapa* ramificacao, int atacante, int defensor,
+                        struct GeradorDados* gerador, struct ResultadoBatalha* resultado) {
+    int motivo = motivoRejeicao(territorioNaRamificacao(ramificacao, atacante),
+                                territorioNaRamificacao(ramificacao, defensor), atacante, defensor);
+    if (motivo != ATAQUE_VALIDO) {
+        return motivo;
+    }
+    
+    // Reserva antes para que a segunda cópia não mova a primeira
+    if (!reservarRamificacao(ramificacao, 2)) {
+        return -1;
+    }
+    struct Territorio* copiaAtacante = alterarNaRamificacao(ramificacao, atacante);
+    struct Territorio* copiaDefensor = alterarNaRamificacao(ramificacao, defensor);
+    
+    resolverBatalha(copiaAtacante, copiaDefensor, gerador, resultado);
+    return ATAQUE_VALIDO;
+}
+
+/*
+ * Função para ler o relógio de parede em segundos
+ */
+double relogioSegundos() {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return agora.tv_sec + agora.tv_nsec * 1e-9;
+}
+
+/*
+ * Análise de viabilidade das missões
+ * 
+ * Para cada cor e cada missão, estima quantos ataques ainda faltam:
+ * - limiteInferior: conquistas que nenhuma sequência de ataques evita (cada
+ *   conquista custa pelo menos um ataque); -1 = inviável só com ataques da
+ *   própria cor
+ * - ataquesEsperados: ataques esperados pelas probabilidades de combate da
+ *   regra em uso; INFINITY se as tropas atuais não alcançam a missão
+ * 
+ * Uma busca em largura a partir dos territórios da cor dá o mínimo de
+ * conquistas até cada território (o limite inferior). Uma expansão gulosa
+ * pelo alvo mais barato, como no algoritmo de Prim, dá o custo esperado de
+ * cada conquista, com as tropas que avançam de uma conquista para a
+ * seguinte. Sem adjacência, todo território inimigo está a uma conquista.
+ * 
+ * Os resultados ficam guardados por cor. atualizarIndiceAlvos anota os
+ * territórios alterados e, na consulta seguinte, só as cores afetadas
+ * (donos antigo e novo e donos dos vizinhos) são refeitas.
+ */
+
+// Posição de cada missão em missoesPredefinidas
+#define MISSAO_CONSECUTIVOS 0
+#define MISSAO_ELIMINAR_VERMELHAS 1
+#define MISSAO_QUATRO_TERRITORIOS 2
+#define MISSAO_DUAS_MIL_TROPAS 3
+#define MISSAO_TRES_CORES 4
+#define MISSAO_REGIAO 5
+
+// Tropas de cada lado acima das quais a tabela de combate satura
+#define LIMITE_TABELA_COMBATE 64
+
+// Faixa em torno da mediana aceita no sorteio equilibrado de missões
+#define FATOR_EQUILIBRIO 4.0
+
+// Exibe a viabilidade das missões no mapa e sai (--viabilidade)
+int analisarViabilidade = 0;
+
+/*
+ * Definição da estrutura TabelaCombate
+ * 
+ * Investida completa de a tropas contra d, atacando até conquistar ou até
+ * o atacante ficar com 1 tropa, pela regra de combate de modo:
+ * - probabilidadeConquista[a][d]: chance de conquistar
+ * - ataquesEsperados[a][d]: ataques esperados da investida
+ */
+struct TabelaCombate {
+    int modo;  // modoCombate da tabela (-1 = não calculada)
+    double probabilidadeConquista[LIMITE_TABELA_COMBATE + 1][LIMITE_TABELA_COMBATE + 1];
+    double ataquesEsperados[LIMITE_TABELA_COMBATE + 1][LIMITE_TABELA_COMBATE + 1];
+};
+
+// Tabela da regra de combate em uso
+struct TabelaCombate tabelaCombate = { .modo = -1 };
+
+/*
+ * Definição da estrutura ViabilidadeMissao
+ * 
+ * Ataques que faltam para uma cor cumprir uma missão (ver acima)
+ */
+struct ViabilidadeMissao {
+    int limiteInferior;
+    double ataquesEsperados;
+};
+
+/*
+ * Definição da estrutura AnaliseViabilidade
+ * 
+ * Resultados guardados por cor e vetores de trabalho da busca, reaproveitados
+ * entre cores:
+ * - saltos: conquistas mínimas até cada território (-1 = inalcançável)
+ * - caminho: ataques esperados até conquistar cada território
+ * - chave: custo da conquista proposta, ordem do heap da expansão
+ * - forca: tropas que chegam ao território conquistado
+ * - heap: heap mínimo da expansão (também a fila da busca em largura)
+ * - posicao: posição no heap (-1 = fora, -2 = já é da cor ou conquistado)
+ * - leitoras: bit c ligado = o resultado guardado da cor c usou as tropas
+ *   do território (proposto como conquista na expansão)
+ */
+struct AnaliseViabilidade {
+    const struct Territorio* mapa;  // Mapa analisado (o do índice de alvos)
+    int tamanho;
+    int modo;                       // modoCombate dos resultados guardados
+    uint64_t calculadas;            // Bit c ligado = resultados da cor c em dia
+    struct ViabilidadeMissao resultado[MAX_CORES][TOTAL_MISSOES];
+    int* saltos;
+    double* caminho;
+    double* chave;
+    int* forca;
+    int* heap;
+    int* posicao;
+    uint64_t* leitoras;
+    int tamanhoHeap;
+};
+
+// Análise do mapa em jogo
+struct AnaliseViabilidade analiseViabilidade;
+
+/*
+ * Função para calcular a tabela de combate da regra em uso
+ * 
+ * Na regra clássica, as perdas de cada rolagem vêm da enumeração de todos
+ * os dados (no máximo 6^6 combinações); as investidas saem de uma
+ * programação dinâmica sobre as tropas restantes dos dois lados.
+ */
+void prepararTabelaCombate() {
+    if (tabelaCombate.modo == modoCombate) {
+        return;
+    }
+    
+    // perdas[na][nd][p]: chance de o atacante perder p tropas rolando na contra nd
+    double perdas[4][4][4];
+    memset(perdas, 0, sizeof(perdas));
+    for (int na = 1; na <= 3 && modoCombate == COMBATE_CLASSICO; na++) {
+        for (int nd = 1; nd <= 3; nd++) {
+            int combinacoes = 1;
+            for (int k = 0; k < na + nd; k++) {
+                combinacoes *= 6;
+            }
+            int pares = na < nd ? na : nd;
+            for (int codigo = 0; codigo < combinacoes; codigo++) {
+                int ataque[3] = {0, 0, 0};
+                int defesa[3] = {0, 0, 0};
+                int resto = codigo;
+                for (int k = 0; k < na; k++, resto /= 6) ataque[k] = resto % 6 + 1;
+                for (int k = 0; k < nd; k++, resto /= 6) defesa[k] = resto % 6 + 1;
+                ordenarTresDados(ataque);
+                ordenarTresDados(defesa);
+                
+                int perdasAtaque = 0;
+                for (int k = 0; k < pares; k++) {
+                    perdasAtaque += ataque[k] <= defesa[k];
+                }
+                perdas[na][nd][perdasAtaque] += 1.0 / combinacoes;
+            }
+        }
+    }
+    
+    // Dado único: 15 das 36 rolagens dão vitória ao atacante
+    const double vitoria = 15.0 / 36.0;
+    for (int a = 0; a <= LIMITE_TABELA_COMBATE; a++) {
+        for (int d = 0; d <= LIMITE_TABELA_COMBATE; d++) {
+            double probabilidade = 0.0;
+            double ataques = 0.0;
+            
+            if (d == 0) {
+                probabilidade = 1.0;
+            } else if (a >= 2 && modoCombate == COMBATE_DADO_UNICO) {
+                probabilidade = vitoria + (1.0 - vitoria) * tabelaCombate.probabilidadeConquista[a - 1][d];
+                ataques = 1.0 + (1.0 - vitoria) * tabelaCombate.ataquesEsperados[a - 1][d];
+            } else if (a >= 2) {
+                int na = a - 1 > 3 ? 3 : a - 1;
+                int nd = d > 3 ? 3 : d;
+                int pares = na < nd ? na : nd;
+                ataques = 1.0;
+                for (int p = 0; p <= pares; p++) {
+                    double chance = perdas[na][nd][p];
+                    probabilidade += chance * tabelaCombate.probabilidadeConquista[a - p][d - (pares - p)];
+                    ataques += chance * tabelaCombate.ataquesEsperados[a - p][d - (pares - p)];
+                }
+            }
+            tabelaCombate.probabilidadeConquista[a][d] = probabilidade;
+            tabelaCombate.ataquesEsperados[a][d] = ataques;
+        }
+    }
+    tabelaCombate.modo = modoCombate;
+}
+
+/*
+ * Função para estimar os ataques necessários para uma conquista
+ * 
+ * Parâmetros:
+ * - forca: tropas do território atacante
+ * - tropas: tropas do território defensor
+ * 
+ * Retorna:
+ * - Ataques esperados por conquista (investidas que fracassam são
+ *   refeitas com a mesma força), ou INFINITY se a força não basta
+ */
+double custoConquista(int forca, int tropas) {
+    int a = forca > LIMITE_TABELA_COMBATE ? LIMITE_TABELA_COMBATE : forca;
+    int d = tropas > LIMITE_TABELA_COMBATE ? LIMITE_TABELA_COMBATE : tropas;
+    d = d < 1 ? 1 : d;  // Mesmo um território vazio custa um ataque
+    if (a < 2) {
+        return INFINITY;
+    }
+    
+    double probabilidade = tabelaCombate.probabilidadeConquista[a][d];
+    if (probabilidade < 1e-12) {
+        return INFINITY;
+    }
+    return tabelaCombate.ataquesEsperados[a][d] / probabilidade;
+}
+
+/*
+ * Função para estimar as tropas que avançam após uma conquista
+ * 
+ * Dado único: metade das tropas do atacante. Clássica: tantas quanto os
+ * dados de ataque, deixando ao menos uma para trás.
+ */
+int forcaAposConquista(int forca) {
+    if (modoCombate == COMBATE_DADO_UNICO) {
+        return forca / 2;
+    }
+    return forca - 1 < 3 ? forca - 1 : 3;
+}
+
+/*
+ * Função para liberar os vetores da análise de viabilidade
+ */
+void liberarAnaliseViabilidade() {
+    struct AnaliseViabilidade* analise = &analiseViabilidade;
+    liberarVetorGrande(analise->saltos);
+    liberarVetorGrande(analise->caminho);
+    liberarVetorGrande(analise->chave);
+    liberarVetorGrande(analise->forca);
+    liberarVetorGrande(analise->heap);
+    liberarVetorGrande(analise->posicao);
+    liberarVetorGrande(analise->leitoras);
+    memset(analise, 0, sizeof(*analise));
+}
+
+/*
+ * Função para comparar dois territórios no heap da expansão
+ * 
+ * Retorna:
+ * - Verdadeiro se a conquista de a é mais barata que a de b (empate: menor
+ *   índice, para que a expansão não dependa da ordem de inserção)
+ */
+static inline int conquistaMaisBarata(int a, int b) {
+    const double* chave = analiseViabilidade.chave;
+    return chave[a] < chave[b] || (chave[a] == chave[b] && a < b);
+}
+
+/*
+ * Função para subir um território no heap da expansão
+ */
+void subirNaExpansao(int posicao) {
+    struct AnaliseViabilidade* analise = &analiseViabilidade;
+    int item = analise->heap[posicao];
+    
+    while (posicao > 0) {
+        int pai = (posicao - 1) / 2;
+        if (!conquistaMaisBarata(item, analise->heap[pai])) {
+            break;
+        }
+        analise->heap[posicao] = analise->heap[pai];
+        analise->posicao[analise->heap[posicao]] = posicao;
+        posicao = pai;
+    }
+    analise->heap[posicao] = item;
+    analise->posicao[item] = posicao;
+}
+
+/*
+ * Função para retirar a conquista mais barata do heap da expansão
+ * 
+ * Retorna:
+ * - Índice do território retirado (marcado como conquistado)
+ */
+int retirarDaExpansao() {
+    struct AnaliseViabilidade* analise = &analiseViabilidade;
+    int topo = analise->heap[0];
+    int item = analise->heap[--analise->tamanhoHeap];
+    int posicao = 0;
+    
+    for (;;) {
+        int filho = 2 * posicao + 1;
+        if (filho >= analise->tamanhoHeap) {
+            break;
+        }
+        if (filho + 1 < analise->tamanhoHeap &&
+            conquistaMaisBarata(analise->heap[filho + 1], analise->heap[filho])) {
+            filho++;
+        }
+        if (!conquistaMaisBarata(analise->heap[filho], item)) {
+            break;
+        }
+        analise->heap[posicao] = analise->heap[filho];
+        analise->posicao[analise->heap[posicao]] = posicao;
+        posicao = filho;
+    }
+    if (analise->tamanhoHeap > 0) {
+        analise->heap[posicao] = item;
+        analise->posicao[item] = posicao;
+    }
+    analise->posicao[topo] = -2;
+    return topo;
+}
+
+/*
+ * Função para propor a conquista de um território na expansão
+ * 
+ * Parâmetros:
+ * - alvo: território proposto
+ * - forca: tropas de quem ataca
+ * - caminhoOrigem: ataques esperados até conquistar quem ataca
+ * - leitora: bit da cor analisada, anotado no alvo
+ * 
+ * Mantém, para cada alvo, a proposta mais barata vista até agora.
+ */
+void proporConquista(int alvo, int forca, double caminhoOrigem, uint64_t leitora) {
+    struct AnaliseViabilidade* analise = &analiseViabilidade;
+    if (analise->posicao[alvo] == -2) {
+        return;
+    }
+    
+    analise->leitoras[alvo] |= leitora;
+    double custo = custoConquista(forca, analise->mapa[alvo].tropas);
+    if (custo == INFINITY) {
+        return;
+    }
+    
+    if (analise->posicao[alvo] == -1) {
+        analise->heap[analise->tamanhoHeap] = alvo;
+        analise->posicao[alvo] = analise->tamanhoHeap++;
+    } else if (custo >= analise->chave[alvo]) {
+        return;
+    }
+    analise->chave[alvo] = custo;
+    analise->caminho[alvo] = caminhoOrigem + custo;
+    analise->forca[alvo] = forcaAposConquista(forca);
+    subirNaExpansao(analise->posicao[alvo]);
+}
+
+/*
+ * Função para preencher uma viabilidade de contagem de territórios
+ * 
+ * Parâmetros:
+ * - viabilidade: ponteiro para o resultado
+ * - faltam: territórios que ainda faltam conquistar
+ * - alcancaveis: territórios inimigos ligados aos da cor
+ * - somaConquistas: ataques esperados das faltam conquistas mais baratas
+ *   (INFINITY se a expansão parou antes)
+ */
+void viabilidadeDeContagem(struct ViabilidadeMissao* viabilidade, int faltam, int alcancaveis,
+                           double somaConquistas) {
+    if (faltam <= 0) {
+        viabilidade->limiteInferior = 0;
+        viabilidade->ataquesEsperados = 0.0;
+    } else if (faltam > alcancaveis) {
+        viabilidade->limiteInferior = -1;
+        viabilidade->ataquesEsperados = INFINITY;
+    } else {
+        viabilidade->limiteInferior = faltam;
+        viabilidade->ataquesEsperados = somaConquistas;
+    }
+}
+
+/*
+ * Função para calcular a viabilidade de todas as missões para uma cor
+ * 
+ * Parâmetros:
+ * - cor: identificador da cor
+ * 
+ * Refaz a busca em largura e a expansão a partir dos territórios atuais da
+ * cor e guarda o resultado de cada missão. O índice de alvos deve estar
+ * ativo sobre analiseViabilidade.mapa.
+ */
+void calcularViabilidadeCor(int cor) {
+    struct AnaliseViabilidade* analise = &analiseViabilidade;
+    struct ViabilidadeMissao* resultado = analise->resultado[cor];
+    const struct Territorio* mapa = analise->mapa;
+    const unsigned char* corDe = indiceAlvos.corDe;
+    int tamanho = analise->tamanho;
+    int possuidos = contarPosse(cor);
+    uint64_t leitora = 1ULL << cor;
+    
+    // Busca em largura: mínimo de conquistas até cada território
+    int* fila = analise->heap;
+    int inicio = 0;
+    int fim = 0;
+    for (int i = 0; i < tamanho; i++) {
+        analise->saltos[i] = -1;
+        if (corDe[i] == cor) {
+            analise->saltos[i] = 0;
+            fila[fim++] = i;
+        } else if (!adjacencia.ativa && possuidos > 0) {
+            analise->saltos[i] = 1;
+        }
+    }
+    while (inicio < fim && adjacencia.ativa) {
+        int atual = fila[inicio++];
+        for (int k = adjacencia.inicio[atual]; k < adjacencia.inicio[atual + 1]; k++) {
+            int vizinho = adjacencia.vizinhos[k];
+            if (analise->saltos[vizinho] < 0) {
+                analise->saltos[vizinho] = analise->saltos[atual] + 1;
+                fila[fim++] = vizinho;
+            }
+        }
+    }
+    int alcancaveis = adjacencia.ativa ? fim - possuidos : (possuidos > 0 ? tamanho - possuidos : 0);
+    
+    // Expansão pela conquista mais barata, partindo das tropas atuais da cor
+    int forcaMaxima = 0;
+    analise->tamanhoHeap = 0;
+    for (int i = 0; i < tamanho; i++) {
+        analise->posicao[i] = -1;
+        analise->caminho[i] = INFINITY;
+        analise->leitoras[i] &= ~leitora;
+        if (corDe[i] == cor) {
+            analise->posicao[i] = -2;
+            analise->caminho[i] = 0.0;
+            analise->forca[i] = mapa[i].tropas;
+            forcaMaxima = mapa[i].tropas > forcaMaxima ? mapa[i].tropas : forcaMaxima;
+        }
+    }
+    for (int i = 0; i < tamanho; i++) {
+        if (!adjacencia.ativa) {
+            // Sem fronteiras, o território mais forte da cor ataca qualquer um
+            if (corDe[i] != cor) {
+                proporConquista(i, forcaMaxima, 0.0, leitora);
+            }
+        } else if (corDe[i] == cor) {
+            for (int k = adjacencia.inicio[i]; k < adjacencia.inicio[i + 1]; k++) {
+                proporConquista(adjacencia.vizinhos[k], analise->forca[i], 0.0, leitora);
+            }
+        }
+    }
+    
+    // As missões de contagem só precisam da soma das k conquistas mais baratas
+    int faltamQuatro = 4 - possuidos;
+    int faltamTres = 3 - possuidos;
+    int faltamMetade = tamanho / 2 - possuidos;
+    double somaQuatro = INFINITY, somaTres = INFINITY, somaMetade = INFINITY;
+    double soma = 0.0;
+    int conquistas = 0;
+    
+    while (analise->tamanhoHeap > 0) {
+        int alvo = retirarDaExpansao();
+        soma += analise->chave[alvo];
+        conquistas++;
+        if (conquistas == faltamQuatro) somaQuatro = soma;
+        if (conquistas == faltamTres) somaTres = soma;
+        if (conquistas == faltamMetade) somaMetade = soma;
+        
+        if (adjacencia.ativa && analise->forca[alvo] >= 2) {
+            for (int k = adjacencia.inicio[alvo]; k < adjacencia.inicio[alvo + 1]; k++) {
+                proporConquista(adjacencia.vizinhos[k], analise->forca[alvo], analise->caminho[alvo],
+                                leitora);
+            }
+        }
+    }
+    
+    viabilidadeDeContagem(&resultado[MISSAO_QUATRO_TERRITORIOS], faltamQuatro, alcancaveis, somaQuatro);
+    viabilidadeDeContagem(&resultado[MISSAO_TRES_CORES], faltamTres, alcancaveis, somaTres);
+    viabilidadeDeContagem(&resultado[MISSAO_REGIAO], faltamMetade, alcancaveis, somaMetade);
+    
+    // Tropas nunca aumentam: a missão já está cumprida ou não tem como ser
+    int tropasSuficientes = somarTropasPosse(cor) > 2000;
+    resultado[MISSAO_DUAS_MIL_TROPAS].limiteInferior = tropasSuficientes ? 0 : -1;
+    resultado[MISSAO_DUAS_MIL_TROPAS].ataquesEsperados = tropasSuficientes ? 0.0 : INFINITY;
+    
+    // Três consecutivos: a janela de três territórios mais próxima
+    struct ViabilidadeMissao* consecutivos = &resultado[MISSAO_CONSECUTIVOS];
+    consecutivos->limiteInferior = -1;
+    consecutivos->ataquesEsperados = INFINITY;
+    if (maiorSequenciaBits(indiceAlvos.posse[cor], indiceAlvos.palavras) >= 3) {
+        consecutivos->limiteInferior = 0;
+        consecutivos->ataquesEsperados = 0.0;
+    } else {
+        for (int i = 0; i + 2 < tamanho; i++) {
+            int faltam = 0;
+            int maisDistante = 0;
+            double custo = 0.0;
+            for (int j = i; j < i + 3; j++) {
+                if (corDe[j] != cor) {
+                    faltam++;
+                    maisDistante = analise->saltos[j] < 0 || maisDistante < 0 ? -1 :
+                                   (analise->saltos[j] > maisDistante ? analise->saltos[j] : maisDistante);
+                    custo += analise->caminho[j];
+                }
+            }
+            if (maisDistante < 0) {
+                continue;
+            }
+            int limite = faltam > maisDistante ? faltam : maisDistante;
+            if (consecutivos->limiteInferior < 0 || limite < consecutivos->limiteInferior) {
+                consecutivos->limiteInferior = limite;
+            }
+            if (custo < consecutivos->ataquesEsperados) {
+                consecutivos->ataquesEsperados = custo;
+            }
+        }
+    }
+    
+    // Eliminar as vermelhas: conquistar todos os territórios vermelhos
+    struct ViabilidadeMissao* vermelhas = &resultado[MISSAO_ELIMINAR_VERMELHAS];
+    int vermelho = buscarIdCor("Vermelho");
+    int vermelhoMinusculo = buscarIdCor("vermelho");
+    int totalVermelhos = 0;
+    int maisDistante = 0;
+    double custo = 0.0;
+    for (int i = 0; i < tamanho && maisDistante >= 0; i++) {
+        if (corDe[i] == vermelho || corDe[i] == vermelhoMinusculo) {
+            totalVermelhos++;
+            // Uma cor vermelha não conquista os próprios territórios
+            int saltos = corDe[i] == cor ? -1 : analise->saltos[i];
+            maisDistante = saltos < 0 ? -1 : (saltos > maisDistante ? saltos : maisDistante);
+            custo += analise->caminho[i];
+        }
+    }
+    vermelhas->limiteInferior = maisDistante < 0 ? -1 :
+                                (totalVermelhos > maisDistante ? totalVermelhos : maisDistante);
+    vermelhas->ataquesEsperados = maisDistante < 0 ? INFINITY : custo;
+    
+    analise->calculadas |= 1ULL << cor;
+}
+
+/*
+ * Função para deixar a análise de viabilidade em dia com o índice de alvos
+ * 
+ * Retorna:
+ * - 1 se a análise pode ser consultada
+ * - 0 se o índice de alvos não está ativo ou faltou memória
+ * 
+ * Consome as alterações anotadas por atualizarIndiceAlvos, descartando só
+ * os resultados das cores afetadas: o dono antigo e o novo, as cores que
+ * leram as tropas do território ou de um vizinho (a expansão pode passar
+ * muitos saltos além da fronteira) e os donos dos vizinhos. Um território
+ * vermelho que muda de dono afeta a missão de eliminar as vermelhas de
+ * todas as cores; sem adjacência, qualquer território faz fronteira com
+ * todos.
+ */
+int prepararAnaliseViabilidade() {
+    struct AnaliseViabilidade* analise = &analiseViabilidade;
+    if (!indiceAlvos.ativo) {
+        return 0;
+    }
+    
+    if (analise->mapa != indiceAlvos.mapa || analise->tamanho != indiceAlvos.tamanho) {
+        liberarAnaliseViabilidade();
+        int tamanho = indiceAlvos.tamanho;
+        analise->saltos = (int*)alocarVetorGrande(tamanho, sizeof(int));
+        analise->caminho = (double*)alocarVetorGrande(tamanho, sizeof(double));
+        analise->chave = (double*)alocarVetorGrande(tamanho, sizeof(double));
+        analise->forca = (int*)alocarVetorGrande(tamanho, sizeof(int));
+        analise->heap = (int*)alocarVetorGrande(tamanho, sizeof(int));
+        analise->posicao = (int*)alocarVetorGrande(tamanho, sizeof(int));
+        analise->leitoras = (uint64_t*)alocarVetorGrande(tamanho, sizeof(uint64_t));
+        if (analise->saltos == NULL || analise->caminho == NULL || analise->chave == NULL ||
+            analise->forca == NULL || analise->heap == NULL || analise->posicao == NULL ||
+            analise->leitoras == NULL) {
+            printf("Erro: Memória insuficiente para a análise de viabilidade!\n");
+            liberarAnaliseViabilidade();
+            return 0;
+        }
+        analise->mapa = indiceAlvos.mapa;
+        analise->tamanho = tamanho;
+        alteracoesPendentes.transbordou = 1;
+    }
+    
+    if (analise->modo != modoCombate) {
+        alteracoesPendentes.transbordou = 1;
+    }
+    prepararTabelaCombate();
+    analise->modo = modoCombate;
+    
+    int vermelho = buscarIdCor("Vermelho");
+    int vermelhoMinusculo = buscarIdCor("vermelho");
+    for (int k = 0; k < alteracoesPendentes.total && !alteracoesPendentes.transbordou; k++) {
+        int territorio = alteracoesPendentes.indice[k];
+        int corAntiga = alteracoesPendentes.corAntiga[k];
+        int corNova = indiceAlvos.corDe[territorio];
+        
+        if (!adjacencia.ativa ||
+            corAntiga == vermelho || corAntiga == vermelhoMinusculo ||
+            corNova == vermelho || corNova == vermelhoMinusculo) {
+            alteracoesPendentes.transbordou = 1;
+            break;
+        }
+        analise->calculadas &= ~((1ULL << corAntiga) | (1ULL << corNova) | analise->leitoras[territorio]);
+        for (int v = adjacencia.inicio[territorio]; v < adjacencia.inicio[territorio + 1]; v++) {
+            int vizinho = adjacencia.vizinhos[v];
+            analise->calculadas &= ~((1ULL << indiceAlvos.corDe[vizinho]) | analise->leitoras[vizinho]);
+        }
+    }
+    if (alteracoesPendentes.transbordou) {
+        analise->calculadas = 0;
+    }
+    alteracoesPendentes.total = 0;
+    alteracoesPendentes.transbordou = 0;
+    return 1;
+}
+
+/*
+ * Função para consultar a viabilidade das missões de uma cor
+ * 
+ * Parâmetros:
+ * - cor: identificador da cor
+ * 
+ * Retorna:
+ * - Vetor com TOTAL_MISSOES resultados, na ordem de missoesPredefinidas
+ * - NULL se a análise não está disponível
+ * 
+ * O vetor só vale até a próxima alteração do mapa.
+ */
+const struct ViabilidadeMissao* consultarViabilidade(int cor) {
+    if (cor < 0 || cor >= MAX_CORES || !prepararAnaliseViabilidade()) {
+        return NULL;
+    }
+    if (!(analiseViabilidade.calculadas & (1ULL << cor))) {
+        calcularViabilidadeCor(cor);
+    }
+    return analiseViabilidade.resultado[cor];
+}
+
+/*
+ * Função para pôr em dia a viabilidade de todas as cores do mapa
+ * 
+ * Retorna:
+ * - Número de cores recalculadas
+ * - -1 se a análise não está disponível
+ */
+int atualizarViabilidade() {
+    int refeitas = 0;
+    
+    if (!prepararAnaliseViabilidade()) {
+        return -1;
+    }
+    for (int c = 0; c < totalCores; c++) {
+        if (!posseVazia(c) && !(analiseViabilidade.calculadas & (1ULL << c))) {
+            calcularViabilidadeCor(c);
+            refeitas++;
+        }
+    }
+    return refeitas;
+}
+
+/*
+ * Função para exibir a viabilidade das missões de todas as cores do mapa
+ * 
+ * Mostra também quantas cores precisaram ser refeitas e o tempo gasto.
+ */
+void exibirViabilidade() {
+    double inicio = relogioSegundos();
+    int refeitas = atualizarViabilidade();
+    double segundos = relogioSegundos() - inicio;
+    
+    if (refeitas < 0) {
+        printf("\nAnálise de viabilidade indisponível (índice de alvos inativo).\n");
+        return;
+    }
+    
+    printf("\n=== VIABILIDADE DAS MISSÕES (ataques que faltam) ===\n");
+    for (int c = 0; c < totalCores; c++) {
+        if (posseVazia(c)) {
+            continue;
+        }
+        printf("%s%s: %d territórios, %lld tropas\n", coresRegistradas[c],
+               strcmp(coresRegistradas[c], corJogador) == 0 ? " (você)" : "",
+               contarPosse(c), somarTropasPosse(c));
+        printf("  %8s %11s  missão\n", "mínimo", "estimativa");
+        for (int m = 0; m < TOTAL_MISSOES; m++) {
+            const struct ViabilidadeMissao* viabilidade = &analiseViabilidade.resultado[c][m];
+            if (viabilidade->limiteInferior < 0) {
+                printf("  %8s %11s  %s\n", "inviável", "-", missoesPredefinidas[m]);
+            } else if (viabilidade->ataquesEsperados == INFINITY) {
+                printf("  %8d %11s  %s\n", viabilidade->limiteInferior, "sem tropas", missoesPredefinidas[m]);
+            } else {
+                printf("  %8d %11.1f  %s\n", viabilidade->limiteInferior,
+                       viabilidade->ataquesEsperados, missoesPredefinidas[m]);
+            }
+        }
+    }
+    printf("(%d de %d cores recalculadas em %.3f s)\n", refeitas, totalCores, segundos);
+}
+
+/*
+ * Função para atribuir uma missão de dificuldade equilibrada ao jogador
+ * 
+ * Parâmetros:
+ * - destino: ponteiro para onde a missão será copiada (passagem por referência)
+ * - missoes: vetor de strings com as missões disponíveis
+ * - totalMissoes: número total de missões disponíveis
+ * 
+ * Com a análise de viabilidade disponível para a cor do jogador, o sorteio
+ * fica entre as missões ainda não cumpridas, alcançáveis com as tropas
+ * atuais e com estimativa de ataques a até FATOR_EQUILIBRIO vezes da
+ * mediana dessas candidatas: nem de graça, nem muito mais longa que as
+ * demais. Sem análise ou sem candidatas, sorteia entre todas.
+ * 
+ * A análise só existe com o mapa já indexado (--mapa). Em mapas sem
+ * fronteiras ela é pulada: qualquer inimigo está a uma conquista, e cada
+ * ataque obrigaria a refazer a análise de todas as cores.
+ */
+void atribuirMissao(char* destino, char* missoes[], int totalMissoes) {
+    const struct ViabilidadeMissao* viabilidade = NULL;
+    if (missoes == missoesPredefinidas && totalMissoes == TOTAL_MISSOES && adjacencia.ativa) {
+        viabilidade = consultarViabilidade(buscarIdCor(corJogador));
+    }
+    
+    int candidatas[TOTAL_MISSOES];
+    int totalCandidatas = 0;
+    for (int m = 0; viabilidade != NULL && m < totalMissoes; m++) {
+        if (viabilidade[m].limiteInferior > 0 && viabilidade[m].ataquesEsperados != INFINITY) {
+            candidatas[totalCandidatas++] = m;
+        }
+    }
+    
+    if (totalCandidatas > 0) {
+        // Mediana das estimativas (ordenação por inserção: no máximo 6 missões)
+        double estimativas[TOTAL_MISSOES];
+        for (int k = 0; k < totalCandidatas; k++) {
+            double valor = viabilidade[candidatas[k]].ataquesEsperados;
+            int j = k;
+            while (j > 0 && estimativas[j - 1] > valor) {
+                estimativas[j] = estimativas[j - 1];
+                j--;
+            }
+            estimativas[j] = valor;
+        }
+        double mediana = estimativas[totalCandidatas / 2];
+        
+        int equilibradas = 0;
+        for (int k = 0; k < totalCandidatas; k++) {
+            double valor = viabilidade[candidatas[k]].ataquesEsperados;
+            if (valor <= mediana * FATOR_EQUILIBRIO && valor * FATOR_EQUILIBRIO >= mediana) {
+                candidatas[equilibradas++] = candidatas[k];
+            }
+        }
+        strcpy(destino, missoes[candidatas[rand() % equilibradas]]);
+        return;
+    }
+    
+    int indiceMissao = rand() % totalMissoes;
+    strcpy(destino, missoes[indiceMissao]);
+}
+
+/*
+ * Definição da estrutura ResultadoPartida
+ * 
+ * Resumo de uma partida automática:
+ * - vencedor: identificador da cor vencedora (-1 = sem vencedor)
+ * - missaoDe: missão sorteada para cada cor (índice em missoesPredefinidas)
+ * - rodadas: rodadas jogadas (cada jogador ataca no máximo uma vez por rodada)
+ * - ataques: ataques realizados
+ */
+struct ResultadoPartida {
+    int vencedor;
+    int missaoDe[MAX_CORES];
+    int rodadas;
+    long long ataques;
+};
+
+// Limite de rodadas de uma partida automática
+#define MAX_RODADAS 10000
+
+/*
+ * Definição da estrutura AtaqueLote
+ * 
+ * Um ataque submetido em lote:
+ * - atacante/defensor: índices no mapa (preenchidos por quem submete)
+ * - valido: 1 se o ataque passou em validarAtaque na hora de executar
+ * - resultado: registro da batalha, se válido
+ * - tropasAtacante/tropasDefensor: tropas logo após o ataque, aplicadas ao
+ *   mapa pela thread chamadora na ordem de submissão
+ */
+struct AtaqueLote {
+    int atacante;
+    int defensor;
+    int valido;
+    char corAtacante[10];
+    char corDefensor[10];
+    struct ResultadoBatalha resultado;
+    int tropasAtacante;
+    int tropasDefensor;
+};
+
+/*
+ * Definição da estrutura TrabalhoLote
+ * 
+ * Estado compartilhado pelas threads que executam um lote. Os ataques são
+ * agrupados em ondas: dentro de uma onda nenhum território aparece duas
+ * vezes, então a onda inteira pode rodar em paralelo.
+ */
+struct TrabalhoLote {
+    struct Territorio* mapa;
+    struct AtaqueLote* ataques;
+    int* ordem;                  // Índices dos ataques, agrupados por onda
+    int* inicioOnda;             // Onda w = ordem[inicioOnda[w] .. inicioOnda[w + 1])
+    int totalOndas;
+    uint64_t semente;            // Semente do lote
+    int numThreads;              // Threads que de fato participam
+    pthread_barrier_t barreira;  // Sincroniza o início e o fim de cada onda
+    pthread_mutex_t trava;       // Protege 'largada'
+    pthread_cond_t sinal;        // Avisa que as threads podem começar
+    int largada;                 // 1 quando numThreads e a barreira estão prontos
+};
+
+// Participante de um lote: o trabalho e a posição da thread (0 = chamadora)
+struct ParticipanteLote {
+    struct TrabalhoLote* trabalho;
+    int id;
+};
+
+/*
+ * Função para executar um ataque do lote
+ * 
+ * Parâmetros:
+ * - trabalho: estado do lote
+ * - indice: posição do ataque no lote
+ * 
+ * Cada ataque tem o seu próprio fluxo de dados, derivado da semente do lote
+ * e da posição do ataque: o resultado não depende de qual thread o executa.
+ * 
+ * O ataque não fica no mapa: o estado final é guardado no próprio ataque e
+ * os dois territórios voltam ao que eram. Os heaps do índice de alvos leem
+ * as tropas do mapa, então cada mudança só pode aparecer lá junto com a sua
+ * atualização do índice (ver aplicarResultadoLote).
+ */
+void executarAtaqueLote(struct TrabalhoLote* trabalho, int indice) {
+    struct AtaqueLote* ataque = &trabalho->ataques[indice];
+    struct Territorio* atacante = &trabalho->mapa[ataque->atacante];
+    struct Territorio* defensor = &trabalho->mapa[ataque->defensor];
+    struct GeradorDados gerador;
+    
+    ataque->valido = validarAtaque(atacante, defensor);
+    if (!ataque->valido) {
+        return;
+    }
+    
+    strcpy(ataque->corAtacante, atacante->cor);
+    strcpy(ataque->corDefensor, defensor->cor);
+    int tropasAtacante = atacante->tropas;
+    int tropasDefensor = defensor->tropas;
+    iniciarGerador(&gerador, trabalho->semente ^ ((uint64_t)(indice + 1) * 0xD1B54A32D192ED03ULL));
+    resolverBatalha(atacante, defensor, &gerador, &ataque->resultado);
+    
+    // Guarda o resultado e desfaz: os territórios da onda são disjuntos
+    ataque->tropasAtacante = atacante->tropas;
+    ataque->tropasDefensor = defensor->tropas;
+    atacante->tropas = tropasAtacante;
+    defensor->tropas = tropasDefensor;
+    strcpy(defensor->cor, ataque->corDefensor);
+}
+
+/*
+ * Função para aplicar ao mapa o resultado de um ataque do lote
+ * 
+ * Parâmetros:
+ * - trabalho: estado do lote
+ * - ataque: ataque já executado e válido
+ * 
+ * Chamada só pela thread chamadora, um ataque por vez e na ordem de
+ * submissão: cada atualização do índice de alvos encontra os heaps da cor
+ * exatamente como o modo serial os deixaria.
+ */
+void aplicarResultadoLote(struct TrabalhoLote* trabalho, struct AtaqueLote* ataque) {
+    struct Territorio* atacante = &trabalho->mapa[ataque->atacante];
+    struct Territorio* defensor = &trabalho->mapa[ataque->defensor];
+    
+    atacante->tropas = ataque->tropasAtacante;
+    defensor->tropas = ataque->tropasDefensor;
+    if (ataque->resultado.conquistou) {
+        strcpy(defensor->cor, ataque->corAtacante);
+    }
+    atualizarIndiceAlvos(atacante);
+    atualizarIndiceAlvos(defensor);
+    publicarEventoBatalha(atacante, defensor, ataque->corAtacante,
+                          ataque->corDefensor, &ataque->resultado);
+}
+
+/*
+ * Função executada por cada thread de um lote (inclusive a chamadora)
+ * 
+ * Em cada onda, a thread executa a sua fatia fixa de ataques. Entre as
+ * ondas, a thread chamadora aplica sozinha, em ordem, os resultados, as
+ * atualizações de índice e os eventos da onda que terminou.
+ */
+void* executarOndasLote(void* argumento) {
+    struct ParticipanteLote* participante = (struct ParticipanteLote*)argumento;
+    struct TrabalhoLote* trabalho = participante->trabalho;
+    
+    // Espera a chamadora saber quantas threads foram criadas
+    pthread_mutex_lock(&trabalho->trava);
+    while (!trabalho->largada) {
+        pthread_cond_wait(&trabalho->sinal, &trabalho->trava);
+    }
+    pthread_mutex_unlock(&trabalho->trava);
+    
+    for (int w = 0; w < trabalho->totalOndas; w++) {
+        int inicio = trabalho->inicioOnda[w];
+        int tamanhoOnda = trabalho->inicioOnda[w + 1] - inicio;
+        int de = inicio + (int)((long long)tamanhoOnda * participante->id / trabalho->numThreads);
+        int ate = inicio + (int)((long long)tamanhoOnda * (participante->id + 1) / trabalho->numThreads);
+        
+        pthread_barrier_wait(&trabalho->barreira);
+        for (int k = de; k < ate; k++) {
+            executarAtaqueLote(trabalho, trabalho->ordem[k]);
+        }
+        pthread_barrier_wait(&trabalho->barreira);
+        
+        if (participante->id == 0) {
+            for (int k = inicio; k < inicio + tamanhoOnda; k++) {
+                struct AtaqueLote* ataque = &trabalho->ataques[trabalho->ordem[k]];
+                if (ataque->valido) {
+                    aplicarResultadoLote(trabalho, ataque);
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Função para aplicar um lote de ataques, em paralelo quando possível
+ * 
+ * Parâmetros:
+ * - mapa: ponteiro para o vetor de territórios
+ * - tamanho: número de territórios no mapa
+ * - ataques: vetor de ataques (atacante e defensor preenchidos)
+ * - total: número de ataques no lote
+ * - semente: semente dos dados do lote
+ * - numThreads: threads a usar (1 = tudo na thread chamadora)
+ * 
+ * Retorna:
+ * - Número de ataques válidos aplicados
+ * - -1 em caso de índice inválido ou falta de memória
+ * 
+ * Cada ataque vai para a onda seguinte à última onda que usou um dos seus
+ * territórios. Assim, ataques sobre o mesmo território são aplicados na
+ * ordem de submissão, e o resultado para uma semente é o mesmo com qualquer
+ * número de threads.
+ */
+int aplicarLoteAtaques(struct Territorio* mapa, int tamanho, struct AtaqueLote* ataques,
+                       int total, uint64_t semente, int numThreads) {
+    struct TrabalhoLote trabalho;
+    struct ParticipanteLote participantes[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    int* ondaDe;                      // Última onda (1-based) de cada território
+    int* ondaAtaque;
+    int aplicados = 0;
+    
+    if (total <= 0) {
+        return 0;
+    }
+    for (int i = 0; i < total; i++) {
+        if (ataques[i].atacante < 0 || ataques[i].atacante >= tamanho ||
+            ataques[i].defensor < 0 || ataques[i].defensor >= tamanho) {
+            return -1;
+        }
+    }
+    
+    ondaDe = (int*)calloc(tamanho, sizeof(int));
+    ondaAtaque = (int*)malloc(total * sizeof(int));
+    trabalho.ordem = (int*)malloc(total * sizeof(int));
+    trabalho.inicioOnda = (int*)calloc(total + 2, sizeof(int));
+    
+    if (ondaDe == NULL || ondaAtaque == NULL || trabalho.ordem == NULL || trabalho.inicioOnda == NULL) {
+        free(ondaDe);
+        free(ondaAtaque);
+        free(trabalho.ordem);
+        free(trabalho.inicioOnda);
+        return -1;
+    }
+    
+    // Agendamento em ondas, na ordem de submissão
+    trabalho.totalOndas = 0;
+    for (int i = 0; i < total; i++) {
+        int a = ataques[i].atacante;
+        int d = ataques[i].defensor;
+        int onda = (ondaDe[a] > ondaDe[d] ? ondaDe[a] : ondaDe[d]) + 1;
+        ondaDe[a] = ondaDe[d] = onda;
+        ondaAtaque[i] = onda - 1;
+        trabalho.inicioOnda[onda]++;
+        if (onda > trabalho.totalOndas) trabalho.totalOndas = onda;
+    }
+    free(ondaDe);
+    
+    // Contagem por onda vira posição inicial; a ordenação é estável
+    for (int w = 1; w <= trabalho.totalOndas; w++) {
+        trabalho.inicioOnda[w] += trabalho.inicioOnda[w - 1];
+    }
+    for (int i = 0; i < total; i++) {
+        trabalho.ordem[trabalho.inicioOnda[ondaAtaque[i]]++] = i;
+    }
+    for (int w = trabalho.totalOndas; w > 0; w--) {
+        trabalho.inicioOnda[w] = trabalho.inicioOnda[w - 1];
+    }
+    trabalho.inicioOnda[0] = 0;
+    
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAX_THREADS) numThreads = MAX_THREADS;
+    
+    trabalho.mapa = mapa;
+    trabalho.ataques = ataques;
+    trabalho.semente = semente;
+    trabalho.largada = 0;
+    pthread_mutex_init(&trabalho.trava, NULL);
+    pthread_cond_init(&trabalho.sinal, NULL);
+    
+    // Validação silenciosa nas threads; as mensagens não fazem sentido aqui
+    int silencioAnterior = modoSilencioso;
+    modoSilencioso = 1;
+    
+    int criadas = 1;
+    for (int t = 0; t < numThreads; t++) {
+        participantes[t].trabalho = &trabalho;
+        participantes[t].id = t;
+        if (t > 0) {
+            if (pthread_create(&threads[t], NULL, executarOndasLote, &participantes[t]) != 0) {
+                break;  // Segue com as threads já criadas
+            }
+            criadas++;
+        }
+    }
+    
+    // Só agora o número de participantes é conhecido
+    trabalho.numThreads = criadas;
+    pthread_barrier_init(&trabalho.barreira, NULL, criadas);
+    pthread_mutex_lock(&trabalho.trava);
+    trabalho.largada = 1;
+    pthread_cond_broadcast(&trabalho.sinal);
+    pthread_mutex_unlock(&trabalho.trava);
+    
+    executarOndasLote(&participantes[0]);
+    for (int t = 1; t < criadas; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    
+    modoSilencioso = silencioAnterior;
+    pthread_barrier_destroy(&trabalho.barreira);
+    pthread_mutex_destroy(&trabalho.trava);
+    pthread_cond_destroy(&trabalho.sinal);
+    
+    for (int i = 0; i < total; i++) {
+        aplicados += ataques[i].valido;
+    }
+    
+    free(ondaAtaque);
+    free(trabalho.ordem);
+    free(trabalho.inicioOnda);
+    return aplicados;
+}
+
+// Ataques que cada jogador automático planeja por rodada (--ataques-por-rodada)
+int ataquesPorRodada = 1;
+
+// Threads do modo em lote das partidas automáticas (0 = um atacar por vez)
+int threadsLote = 0;
+
+// Missão de todas as cores nas partidas automáticas (-1 = sorteada por cor)
+int missaoPartidas = -1;
+
+/*
+ * Função para planejar os ataques de um jogador automático
+ * 
+ * Parâmetros:
+ * - cor: identificador da cor do jogador
+ * - maximo: número máximo de ataques
+ * - ataques: vetor que recebe os ataques planejados
+ * 
+ * Retorna:
+ * - Número de ataques planejados
+ * 
+ * O i-ésimo território mais forte da cor ataca o i-ésimo alvo inimigo
+ * mais fraco, enquanto houver atacantes com pelo menos 2 tropas. Em mapas
+ * com adjacência, cada alvo é atacado pelo vizinho mais forte da cor.
+ */
+int planejarAtaques(int cor, int maximo, struct AtaqueLote* ataques) {
+    int* fortes = (int*)malloc(2 * maximo * sizeof(int));
+    int* alvos = fortes + maximo;
+    int total = 0;
+    
+    if (fortes == NULL) {
+        return 0;
+    }
+    
+    if (adjacencia.ativa) {
+        int numAlvos = buscarAlvosNaFronteira(cor, maximo, alvos);
+        for (int i = 0; i < numAlvos; i++) {
+            ataques[total].atacante = atacanteParaAlvo(cor, alvos[i]);
+            ataques[total].defensor = alvos[i];
+            total++;
+        }
+        free(fortes);
+        return total;
+    }
+    
+    int numFortes = buscarMaisFortesDaCor(cor, maximo, fortes);
+    int numAlvos = buscarAlvosMaisFracos(cor, maximo, alvos);
+    
+    for (int i = 0; i < numFortes && i < numAlvos; i++) {
+        if (indiceAlvos.mapa[fortes[i]].tropas < 2) {
+            break;
+        }
+        ataques[total].atacante = fortes[i];
+        ataques[total].defensor = alvos[i];
+        total++;
+    }
+    
+    free(fortes);
+    return total;
+}
+
+/*
+ * Função para jogar uma partida automática entre as cores do mapa
+ * 
+ * Parâmetros:
+ * - mapa: ponteiro para o vetor de territórios (deve estar indexado)
+ * - tamanho: número de territórios
+ * - gerador: gerador de dados e missões da partida
+ * - maxRodadas: limite de rodadas
+ * - resultado: ponteiro para o resumo da partida
+ * 
+ * Retorna:
+ * - 1 se a partida foi jogada
+ * - 0 se o mapa não está indexado
+ * 
+ * Cada cor presente no início recebe uma missão sorteada. Em cada rodada,
+ * as cores atacam em ordem, pelo mesmo caminho do jogo interativo
+ * (validarAtaque, atacar e verificarMissao), sem exibir mensagens. Com
+ * threadsLote > 0, o turno de todas as cores é planejado de uma vez e
+ * aplicado por aplicarLoteAtaques.
+ */
+int simularPartida(struct Territorio* mapa, int tamanho, struct GeradorDados* gerador,
+                   int maxRodadas, struct ResultadoPartida* resultado) {
+    if (!indiceAlvos.ativo || mapa != indiceAlvos.mapa || tamanho != indiceAlvos.tamanho) {
+        return 0;
+    }
+    
+    int jogadores[MAX_CORES];
+    int totalJogadores = 0;
+    struct GeradorDados* geradorAnterior = geradorAtaques;
+    int silencioAnterior = modoSilencioso;
+    
+    memset(resultado, 0, sizeof(*resultado));
+    resultado->vencedor = -1;
+    
+    for (int c = 0; c < totalCores; c++) {
+        resultado->missaoDe[c] = -1;
+        if (indiceAlvos.maisFracos[c].tamanho > 0) {
+            jogadores[totalJogadores++] = c;
+            resultado->missaoDe[c] = (int)(proximoAleatorio(gerador) % TOTAL_MISSOES);
+            if (missaoPartidas >= 0) {
+                resultado->missaoDe[c] = missaoPartidas;
+            }
+        }
+    }
+    
+    struct AtaqueLote* ataques =
+        (struct AtaqueLote*)malloc((totalJogadores + 1) * ataquesPorRodada * sizeof(struct AtaqueLote));
+    if (ataques == NULL) {
+        return 0;
+    }
+    
+    geradorAtaques = gerador;
+    modoSilencioso = 1;
+    
+    for (int rodada = 0; rodada < maxRodadas && resultado->vencedor == -1; rodada++) {
+        int houveAtaque = 0;
+        
+        if (threadsLote > 0) {
+            // Modo em lote: todos planejam sobre o mesmo estado e o turno
+            // inteiro é aplicado de uma vez
+            int total = 0;
+            for (int j = 0; j < totalJogadores; j++) {
+                total += planejarAtaques(jogadores[j], ataquesPorRodada, ataques + total);
+            }
+            
+            int aplicados = aplicarLoteAtaques(mapa, tamanho, ataques, total,
+                                               proximoAleatorio(gerador), threadsLote);
+            if (aplicados > 0) {
+                resultado->ataques += aplicados;
+                houveAtaque = 1;
+                publicarQuadro(mapa, 0);
+            }
+            
+            for (int j = 0; j < totalJogadores && resultado->vencedor == -1; j++) {
+                int cor = jogadores[j];
+                if (verificarMissaoDaCor(missoesPredefinidas[resultado->missaoDe[cor]], mapa, tamanho,
+                                         coresRegistradas[cor])) {
+                    resultado->vencedor = cor;
+                }
+            }
+        }
+        
+        for (int j = 0; threadsLote == 0 && j < totalJogadores && resultado->vencedor == -1; j++) {
+            int cor = jogadores[j];
+            int total = planejarAtaques(cor, ataquesPorRodada, ataques);
+            
+            for (int a = 0; a < total && resultado->vencedor == -1; a++) {
+                struct Territorio* atacante = &mapa[ataques[a].atacante];
+                struct Territorio* defensor = &mapa[ataques[a].defensor];
+                
+                if (!validarAtaque(atacante, defensor)) {
+                    continue;
+                }
+                
+                atacar(atacante, defensor);
+                resultado->ataques++;
+                houveAtaque = 1;
+                publicarQuadro(mapa, 0);
+                
+                if (verificarMissaoDaCor(missoesPredefinidas[resultado->missaoDe[cor]], mapa, tamanho,
+                                         coresRegistradas[cor])) {
+                    resultado->vencedor = cor;
+                }
+            }
+        }
+        
+        resultado->rodadas = rodada + 1;
+        if (!houveAtaque) {
+            break;  // Ninguém mais consegue atacar
+        }
+    }
+    
+    free(ataques);
+    geradorAtaques = geradorAnterior;
+    modoSilencioso = silencioAnterior;
+    return 1;
+}
+
+/*
+ * Função para assistir a uma partida automática no mapa cadastrado
+ * 
+ * Parâmetros:
+ * - mapa: ponteiro para o vetor de territórios
+ * - quantidade: número de territórios
+ * 
+ * Com a exibição assíncrona ligada, a partida roda sem esperar o terminal
+ * e os quadros intermediários podem ser pulados.
+ */
+void assistirPartida(struct Territorio* mapa, int quantidade) {
+    struct GeradorDados gerador;
+    struct ResultadoPartida resultado;
+    
+    iniciarGerador(&gerador, sementePartida);
+    
+    printf("\n=================================================\n");
+    printf("           PARTIDA AUTOMÁTICA (semente %llu)\n", (unsigned long long)sementePartida);
+    printf("=================================================\n");
+    
+    clock_t inicio = clock();
+    if (!simularPartida(mapa, quantidade, &gerador, MAX_RODADAS, &resultado)) {
+        printf("Partida automática indisponível para este mapa.\n");
+        return;
+    }
+    double segundos = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+    
+    // O estado final é sempre exibido
+    publicarQuadro(mapa, 1);
+    encerrarExibicaoAssincrona();
+    
+    printf("\nRodadas: %d | Ataques: %lld | Tempo: %.3f s\n",
+           resultado.rodadas, resultado.ataques, segundos);
+    if (resultado.vencedor >= 0) {
+        printf("Vencedor: %s, com a missão: %s\n", coresRegistradas[resultado.vencedor],
+               missoesPredefinidas[resultado.missaoDe[resultado.vencedor]]);
+    } else {
+        printf("Partida encerrada sem vencedor.\n");
+    }
+}
+
+/*
+ * Função para exibir sugestões de ataque para o jogador
+ * 
+ * Parâmetros:
+ * - mapa: ponteiro para o vetor de territórios
+ * 
+ * Mostra os alvos inimigos mais fracos e o território do jogador com
+ * mais tropas para atacá-los, consultando o índice de alvos. Em mapas com
+ * adjacência, só entram alvos na fronteira do jogador, cada um com o seu
+ * vizinho mais forte como atacante.
+ */
+void exibirSugestoesAtaque(struct Territorio* mapa) {
+    int alvos[SUGESTOES_ATAQUE];
+    int cor = buscarIdCor(corJogador);          // -1 = cor sem territórios no mapa
+    int atacante = territorioMaisForte(cor);
+    
+    printf("\n--- SUGESTÃO DE ATAQUE ---\n");
+    
+    if (!indiceAlvos.ativo) {
+        printf("Sugestões indisponíveis para este mapa.\n");
+        return;
+    }
+    
+    if (atacante == -1 || mapa[atacante].tropas < 2) {
+        printf("Nenhum território seu tem tropas suficientes para atacar.\n");
+        return;
+    }
+    
+    if (adjacencia.ativa) {
+        int encontrados = buscarAlvosNaFronteira(cor, SUGESTOES_ATAQUE, alvos);
+        if (encontrados == 0) {
+            printf("Nenhum inimigo na sua fronteira pode ser atacado agora.\n");
+            return;
+        }
+        for (int i = 0; i < encontrados; i++) {
+            int vizinho = atacanteParaAlvo(cor, alvos[i]);
+            printf("Alvo %d: [%d] %s (%s) - %d tropas, atacando de [%d] %s (%d tropas)\n", i + 1,
+                   alvos[i] + 1, mapa[alvos[i]].nome, mapa[alvos[i]].cor, mapa[alvos[i]].tropas,
+                   vizinho + 1, mapa[vizinho].nome, mapa[vizinho].tropas);
+        }
+        return;
+    }
+    
+    int encontrados = buscarAlvosMaisFracos(cor, SUGESTOES_ATAQUE, alvos);
+    if (encontrados == 0) {
+        printf("Não há territórios inimigos no mapa.\n");
+        return;
+    }
+    
+    printf("Atacante sugerido: [%d] %s (%d tropas)\n",
+           atacante + 1, mapa[atacante].nome, mapa[atacante].tropas);
+    for (int i = 0; i < encontrados; i++) {
+        printf("Alvo %d: [%d] %s (%s) - %d tropas\n", i + 1, alvos[i] + 1,
+               mapa[alvos[i]].nome, mapa[alvos[i]].cor, mapa[alvos[i]].tropas);
+    }
+}
+
+/*
+ * Função para exibir o placar de todos os jogadores e suas missões
+ * 
+ * Usa uma única varredura estatística do mapa para todas as cores e
+ * mostra, para cada uma, quais missões já estariam cumpridas.
+ */
+void exibirPlacar() {
+    struct EstatisticasMapa estatisticas;
+    
+    printf("\n=================================================\n");
+    printf("           PLACAR DOS JOGADORES\n");
+    printf("=================================================\n");
+    
+    if (!calcularEstatisticas(&estatisticas)) {
+        printf("Placar indisponível para este mapa.\n");
+        return;
+    }
+    
+    for (int c = 0; c < totalCores; c++) {
+        const struct EstatisticasJogador* j = &estatisticas.jogador[c];
+        if (j->territorios == 0) {
+            continue;
+        }
+        
+        printf("\n%s%s\n", coresRegistradas[c],
+               strcmp(coresRegistradas[c], corJogador) == 0 ? " (você)" : "");
+        printf("    Territórios: %d | Tropas: %lld | Cores conquistadas: %d | Maior sequência: %d\n",
+               j->territorios, j->tropas, __builtin_popcountll(j->coresConquistadas),
+               j->maiorSequencia);
+        
+        for (int m = 0; m < TOTAL_MISSOES; m++) {
+            printf("    [%c] %s\n",
+                   verificarMissaoPorEstatisticas(missoesPredefinidas[m], &estatisticas, c) ? 'X' : ' ',
+                   missoesPredefinidas[m]);
+        }
+    }
+    
+    printf("\n=================================================\n");
+}
+
+// Resultados de executarComando
+#define COMANDO_CONTINUAR 0  // Segue lendo comandos
+#define COMANDO_SAIR 1       // Jogador encerrou o modo de batalha
+#define COMANDO_VITORIA 2    // Missão cumprida
+
+// Máximo de palavras em um comando (comando e três argumentos)
+#define PALAVRAS_COMANDO 4
+
+/*
+ * Função para anunciar a vitória do jogador
+ */
+void anunciarVitoria() {
+    printf("\n🎉 PARABÉNS! MISSÃO CUMPRIDA! 🎉\n");
+    printf("=================================================\n");
+    printf("           VITÓRIA!\n");
+    printf("=================================================\n");
+    printf("Você completou sua missão: %s\n", missaoJogador);
+    printf("=================================================\n");
+}
+
+/*
+ * Função para exibir os comandos do modo de batalha
+ */
+void exibirAjudaComandos() {
+    printf("\nComandos (territórios por número ou nome):\n");
+    printf("  A D | atacar A D    A ataca D (só A: pergunta o defensor)\n");
+    printf("  mostrar | m         mostra o mapa\n");
+    printf("  sugerir | d         sugere alvos de ataque\n");
+    printf("  placar | p          placar dos jogadores\n");
+    printf("  missao              mostra sua missão\n");
+    printf("  viabilidade | v     ataques que faltam para cada missão, por cor\n");
+    printf("  simular A D [N]     estima N investidas de A contra D sem alterar o jogo\n");
+    printf("  salvar ARQUIVO      salva o mapa atual (abre com --mapa=ARQUIVO)\n");
+    printf("  sair | n            encerra o modo de batalha\n");
+    printf("  ajuda | ?           esta lista\n");
+    printf("Linhas vazias, 's' e linhas começadas por '#' são ignoradas.\n");
+}
+
+/*
+ * Função para separar as palavras de uma linha de comando (no lugar)
+ * 
+ * Parâmetros:
+ * - linha: linha lida; espaços entre palavras viram terminadores
+ * - palavras: recebe o início de cada palavra
+ * - maximo: espaço em palavras
+ * 
+ * Retorna:
+ * - Número de palavras, ou maximo + 1 se a linha tem palavras demais
+ */
+int separarPalavras(char* linha, char** palavras, int maximo) {
+    int total = 0;
+    char* p = linha;
+    
+    while (1) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0') {
+            return total;
+        }
+        if (total == maximo) {
+            return maximo + 1;
+        }
+        palavras[total++] = p;
+        while (*p != '\0' && *p != ' ' && *p != '\t') p++;
+        if (*p != '\0') {
+            *p++ = '\0';
+        }
+    }
+}
+
+/*
+ * Função para realizar um ataque pedido pelo jogador
+ * 
+ * Retorna:
+ * - COMANDO_VITORIA se o ataque cumpriu a missão
+ * - COMANDO_CONTINUAR caso contrário (inclusive ataque inválido)
+ */
+int realizarAtaque(struct Territorio* mapa, int quantidade, int indiceAtacante, int indiceDefensor) {
+    // Validar ataque
+    if (!validarAtaque(&mapa[indiceAtacante], &mapa[indiceDefensor])) {
+        return COMANDO_CONTINUAR;
+    }
+    
+    // Executar ataque
+    atacar(&mapa[indiceAtacante], &mapa[indiceDefensor]);
+    
+    // Mapa atualizado a cada ataque só para quem joga no terminal
+    if (leitor.interativo) {
+        mostrarMapa(mapa, quantidade);
+    }
+    
+    // Verificar se a missão foi cumprida após o ataque
+    if (verificarMissao(missaoJogador, mapa, quantidade)) {
+        anunciarVitoria();
+        return COMANDO_VITORIA;
+    }
+    return COMANDO_CONTINUAR;
+}
+
+// Simulações feitas pelo comando 'simular' quando o número não é informado
+#define SIMULACOES_HIPOTESE 1000
+
+// Limite de ataques de uma investida simulada
+#define MAX_ATAQUES_INVESTIDA 10000
+
+/*
+ * Definição da estrutura TrabalhoHipotese
+ * 
+ * Parte das simulações de uma investida, feita por uma thread, com os
+ * totais dessa parte.
+ */
+struct TrabalhoHipotese {
+    const struct Territorio* mapa;
+    int tamanho;
+    int atacante, defensor;
+    int inicio, fim;              // Simulações [inicio, fim)
+    long long conquistas;
+    long long ataques;
+    long long tropasDeixadas;     // Tropas no atacante após as conquistas
+    long long tropasOcupantes;    // Tropas no território conquistado
+    size_t memoriaMaxima;         // Maior ramificação usada
+    int erro;                     // 1 se faltou memória
+};
+
+/*
+ * Função executada por cada thread de simularInvestida
+ * 
+ * Cada simulação parte de uma ramificação nova do mapa em jogo e repete o
+ * ataque até conquistar o defensor ou o atacante ficar sem tropas.
+ */
+void* simularHipoteses(void* argumento) {
+    struct TrabalhoHipotese* trabalho = (struct TrabalhoHipotese*)argumento;
+    
+    for (int s = trabalho->inicio; s < trabalho->fim && !trabalho->erro; s++) {
+        struct RamificacaoMapa ramificacao;
+        struct GeradorDados gerador;
+        struct ResultadoBatalha resultado;
+        
+        if (!iniciarRamificacao(&ramificacao, trabalho->mapa, trabalho->tamanho)) {
+            trabalho->erro = 1;
+            break;
+        }
+        iniciarGerador(&gerador, sementePartida ^ misturarBits((uint64_t)s + 1));
+        
+        for (int a = 0; a < MAX_ATAQUES_INVESTIDA; a++) {
+            int motivo = atacarNaRamificacao(&ramificacao, trabalho->atacante, trabalho->defensor,
+                                             &gerador, &resultado);
+            if (motivo == -1) {
+                trabalho->erro = 1;
+            }
+            if (motivo != ATAQUE_VALIDO) {
+                break;
+            }
+            trabalho->ataques++;
+            if (resultado.conquistou) {
+                trabalho->conquistas++;
+                trabalho->tropasDeixadas += territorioNaRamificacao(&ramificacao, trabalho->atacante)->tropas;
+                trabalho->tropasOcupantes += territorioNaRamificacao(&ramificacao, trabalho->defensor)->tropas;
+                break;
+            }
+        }
+        
+        if (memoriaRamificacao(&ramificacao) > trabalho->memoriaMaxima) {
+            trabalho->memoriaMaxima = memoriaRamificacao(&ramificacao);
+        }
+        liberarRamificacao(&ramificacao);
+    }
+    return NULL;
+}
+
+/*
+ * Função para estimar o resultado de uma investida sem alterar o jogo
+ * 
+ * Parâmetros:
+ * - mapa: ponteiro para o vetor de territórios (estado atual)
+ * - quantidade: número de territórios
+ * - atacante, defensor: índices dos territórios
+ * - simulacoes: quantas investidas simular
+ * 
+ * As simulações são divididas entre threads, cada uma com as suas
+ * ramificações do estado atual. Cada simulação tem o próprio gerador
+ * (semente da partida e número da simulação), então o resultado não depende
+ * do número de threads.
+ */
+void simularInvestida(struct Territorio* mapa, int quantidade, int atacante, int defensor, int simulacoes) {
+    struct TrabalhoHipotese trabalhos[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    int criadas[MAX_THREADS];
+    long processadores = sysconf(_SC_NPROCESSORS_ONLN);
+    int numThreads = processadores < 1 ? 1 : (processadores > MAX_THREADS ? MAX_THREADS : (int)processadores);
+    
+    if (numThreads > simulacoes) numThreads = simulacoes;
+    
+    // Sem nenhuma investida válida, explica o motivo pelas mensagens de sempre
+    int silencioAnterior = modoSilencioso;
+    modoSilencioso = 0;
+    if (!validarAtaque(&mapa[atacante], &mapa[defensor])) {
+        modoSilencioso = silencioAnterior;
+        return;
+    }
+    modoSilencioso = silencioAnterior;
+    
+    for (int t = 0; t < numThreads; t++) {
+        memset(&trabalhos[t], 0, sizeof(trabalhos[t]));
+        trabalhos[t].mapa = mapa;
+        trabalhos[t].tamanho = quantidade;
+        trabalhos[t].atacante = atacante;
+        trabalhos[t].defensor = defensor;
+        trabalhos[t].inicio = (int)((long long)simulacoes * t / numThreads);
+        trabalhos[t].fim = (int)((long long)simulacoes * (t + 1) / numThreads);
+        criadas[t] = (t > 0 && pthread_create(&threads[t], NULL, simularHipoteses, &trabalhos[t]) == 0);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        if (!criadas[t]) simularHipoteses(&trabalhos[t]);
+    }
+    for (int t = 1; t < numThreads; t++) {
+        if (criadas[t]) pthread_join(threads[t], NULL);
+    }
+    
+    struct TrabalhoHipotese total;
+    memset(&total, 0, sizeof(total));
+    for (int t = 0; t < numThreads; t++) {
+        total.conquistas += trabalhos[t].conquistas;
+        total.ataques += trabalhos[t].ataques;
+        total.tropasDeixadas += trabalhos[t].tropasDeixadas;
+        total.tropasOcupantes += trabalhos[t].tropasOcupantes;
+        total.erro |= trabalhos[t].erro;
+        if (trabalhos[t].memoriaMaxima > total.memoriaMaxima) {
+            total.memoriaMaxima = trabalhos[t].memoriaMaxima;
+        }
+    }
+    
+    printf("\n--- SIMULAÇÃO: %s ataca %s até conquistar ou parar ---\n",
+           mapa[atacante].nome, mapa[defensor].nome);
+    if (total.erro) {
+        printf("Aviso: memória insuficiente; parte das simulações foi interrompida.\n");
+    }
+    printf("Simulações: %d (%d threads)\n", simulacoes, numThreads);
+    printf("Conquista em %.1f%% das vezes, com %.1f ataques em média\n",
+           100.0 * total.conquistas / simulacoes, (double)total.ataques / simulacoes);
+    if (total.conquistas > 0) {
+        printf("Após conquistar: %.1f tropas no atacante e %.1f no território conquistado (médias)\n",
+               (double)total.tropasDeixadas / total.conquistas,
+               (double)total.tropasOcupantes / total.conquistas);
+    }
+    printf("Memória por simulação: até %zu bytes (cópia do mapa: %zu bytes)\n",
+           total.memoriaMaxima, (size_t)quantidade * sizeof(struct Territorio));
+}
+
+/*
+ * Função para interpretar e executar um comando do modo de batalha
+ * 
+ * Parâmetros:
+ * - linha: linha de comando (alterada pela separação das palavras)
+ * - numeroLinha: número da linha na entrada, para as mensagens de erro
+ * - mapa: ponteiro para o vetor de territórios
+ * - quantidade: número de territórios
+ * 
+ * Retorna:
+ * - COMANDO_CONTINUAR, COMANDO_SAIR ou COMANDO_VITORIA
+ * 
+ * Um comando inválido só gera uma mensagem de erro; a leitura segue na
+ * linha seguinte.
+ */
+int executarComando(char* linha, long numeroLinha, struct Territorio* mapa, int quantidade) {
+    char* palavras[PALAVRAS_COMANDO];
+    int total = separarPalavras(linha, palavras, PALAVRAS_COMANDO);
+    
+    if (total == 0 || palavras[0][0] == '#') {
+        return COMANDO_CONTINUAR;
+    }
+    if (total > PALAVRAS_COMANDO) {
+        printf("Erro (linha %ld): argumentos demais para '%s'.\n", numeroLinha, palavras[0]);
+        return COMANDO_CONTINUAR;
+    }
+    
+    const char* comando = palavras[0];
+    int argumentos = total - 1;
+    
+    if (strcmp(comando, "atacar") == 0 || strcmp(comando, "a") == 0) {
+        if (argumentos != 2) {
+            printf("Erro (linha %ld): use 'atacar ATACANTE DEFENSOR'.\n", numeroLinha);
+            return COMANDO_CONTINUAR;
+        }
+        palavras[0] = palavras[1];
+        palavras[1] = palavras[2];
+        argumentos = 1;
+    } else if (strcmp(comando, "s") == 0 || strcmp(comando, "S") == 0) {
+        return COMANDO_CONTINUAR;  // Resposta "sim" do antigo "Deseja realizar outro ataque?"
+    } else if (strcmp(comando, "sair") == 0 || strcmp(comando, "n") == 0 ||
+               strcmp(comando, "N") == 0 || strcmp(comando, "q") == 0) {
+        return COMANDO_SAIR;
+    } else if (strcmp(comando, "mostrar") == 0 || strcmp(comando, "m") == 0) {
+        mostrarMapa(mapa, quantidade);
+        return COMANDO_CONTINUAR;
+    } else if (strcmp(comando, "sugerir") == 0 || strcmp(comando, "d") == 0 ||
+               strcmp(comando, "D") == 0) {
+        exibirSugestoesAtaque(mapa);
+        return COMANDO_CONTINUAR;
+    } else if (strcmp(comando, "placar") == 0 || strcmp(comando, "p") == 0 ||
+               strcmp(comando, "P") == 0) {
+        exibirPlacar();
+        return COMANDO_CONTINUAR;
+    } else if (strcmp(comando, "missao") == 0) {
+        exibirMissao(missaoJogador);
+        return COMANDO_CONTINUAR;
+    } else if (strcmp(comando, "viabilidade") == 0 || strcmp(comando, "v") == 0) {
+        exibirViabilidade();
+        return COMANDO_CONTINUAR;
+    } else if (strcmp(comando, "simular") == 0) {
+        int simulacoes = SIMULACOES_HIPOTESE;
+        int indiceAtacante = argumentos >= 2 ? resolverTerritorio(palavras[1], quantidade) : -1;
+        int indiceDefensor = argumentos >= 2 ? resolverTerritorio(palavras[2], quantidade) : -1;
+        if (argumentos == 3) {
+            simulacoes = atoi(palavras[3]);
+        }
+        if (indiceAtacante == -1 || indiceDefensor == -1 || simulacoes <= 0) {
+            printf("Erro (linha %ld): use 'simular ATACANTE DEFENSOR [SIMULAÇÕES]'.\n", numeroLinha);
+        } else {
+            simularInvestida(mapa, quantidade, indiceAtacante, indiceDefensor, simulacoes);
+        }
+        return COMANDO_CONTINUAR;
+    } else if (strcmp(comando, "salvar") == 0) {
+        if (argumentos != 1) {
+            printf("Erro (linha %ld): use 'salvar ARQUIVO'.\n", numeroLinha);
+        } else {
+            salvarMapa(palavras[1], mapa, quantidade);
+        }
+        return COMANDO_CONTINUAR;
+    } else if (strcmp(comando, "ajuda") == 0 || strcmp(comando, "?") == 0) {
+        exibirAjudaComandos();
+        return COMANDO_CONTINUAR;
+    } else if (resolverTerritorio(comando, quantidade) == -1) {
+        printf("Erro (linha %ld): comando ou território desconhecido '%s'. "
+               "Digite 'ajuda' para ver os comandos.\n", numeroLinha, comando);
+        return COMANDO_CONTINUAR;
+    }
+    
+    if (argumentos > 1) {
+        printf("Erro (linha %ld): use 'ATACANTE DEFENSOR'.\n", numeroLinha);
+        return COMANDO_CONTINUAR;
+    }
+    
+    // Ataque: palavras[0] é o atacante e palavras[1], se houver, o defensor
+    int indiceAtacante = resolverTerritorio(palavras[0], quantidade);
+    if (indiceAtacante == -1) {
+        printf("Erro (linha %ld): território atacante inválido '%s'.\n", numeroLinha, palavras[0]);
+        return COMANDO_CONTINUAR;
+    }
+    
+    int indiceDefensor;
+    if (argumentos == 0) {
+        printf("\n--- SELEÇÃO DO DEFENSOR ---\n");
+        indiceDefensor = selecionarTerritorio(mapa, quantidade, "defender");
+    } else {
+        indiceDefensor = resolverTerritorio(palavras[1], quantidade);
+        if (indiceDefensor == -1) {
+            printf("Erro (linha %ld): território defensor inválido '%s'.\n", numeroLinha, palavras[1]);
+        }
+    }
+    if (indiceDefensor == -1) {
+        return COMANDO_CONTINUAR;
     }
     
-    // Missão 5: "Conquistar territórios de 3 cores diferentes"
-    if (strcmp(missao, "Conquistar territórios de 3 cores diferentes") == 0) {
-        // Simplificação: verificar se o jogador controla pelo menos 3 territórios
-        int territoriosControlados = 0;
+    return realizarAtaque(mapa, quantidade, indiceAtacante, indiceDefensor);
+}
+
+/*
+ * Função para gerenciar o loop de batalhas com verificação de missão
+ * 
+ * Parâmetros:
+ * - mapa: ponteiro para o vetor de territórios
+ * - quantidade: número total de territórios
+ * 
+ * Lê um comando por linha (ver exibirAjudaComandos) até a vitória, o
+ * comando 'sair' ou o fim da entrada. No terminal, o mapa é mostrado de
+ * novo após cada ataque; em scripts e pipes, só com 'mostrar'.
+ */
+void gerenciarBatalhas(struct Territorio* mapa, int quantidade) {
+    char linha[TAMANHO_LINHA_COMANDO];
+    int estado = COMANDO_CONTINUAR;
+    
+    printf("\n=================================================\n");
+    printf("           MODO DE BATALHA ATIVADO\n");
+    printf("=================================================\n");
+    
+    construirIndiceNomes(mapa, quantidade);
+    
+    // Exibir mapa atual (pela thread de exibição, se ligada)
+    mostrarMapa(mapa, quantidade);
+    
+    // Verificar se a missão já está cumprida (verificação silenciosa)
+    if (verificarMissao(missaoJogador, mapa, quantidade)) {
+        anunciarVitoria();
+        estado = COMANDO_VITORIA;
+    } else if (leitor.interativo) {
+        exibirAjudaComandos();
+    }
+    
+    while (estado == COMANDO_CONTINUAR) {
+        if (leitor.interativo) {
+            printf("\nComando: ");
+        }
         
-        for (int i = 0; i < tamanho; i++) {
-            if (strcmp(mapa[i].cor, corJogador) == 0) {
-                territoriosControlados++;
+        long numeroLinha = leitor.linha;
+        int tamanho = lerLinha(linha, sizeof(linha));
+        if (tamanho == -1) {
+            break;  // Fim da entrada ou do script
+        }
+        if (tamanho == -2) {
+            printf("Erro (linha %ld): linha longa demais; ignorada.\n", numeroLinha);
+            continue;
+        }
+        
+        estado = executarComando(linha, numeroLinha, mapa, quantidade);
+    }
+    
+    liberarIndiceNomes();
+    printf("\nModo de batalha encerrado.\n");
+}
+
+/*
+ * Função para liberar a memória alocada dinamicamente
+ * 
+ * Parâmetros:
+ * - mapa: ponteiro para o vetor de territórios a ser liberado
+ */
+void liberarMemoria(struct Territorio* mapa) {
+    liberarAnaliseViabilidade();
+    liberarIndiceAlvos();
+    liberarAdjacencia();
+    
+    if (mapa != NULL) {
+        liberarVetorGrande(mapa);
+        printf("\nMemória dos territórios liberada com sucesso.\n");
+    }
+    
+    if (missaoJogador != NULL) {
+        free(missaoJogador);
+        printf("Memória da missão liberada com sucesso.\n");
+    }
+}
+
+/*
+ * Função para consultar quantos KiB do processo estão em páginas grandes
+ * 
+ * Retorna:
+ * - KiB em páginas grandes (transparentes ou reservadas)
+ * - -1 se o sistema não informa
+ */
+long paginasGrandesEmUso() {
+    FILE* arquivo = fopen("/proc/self/smaps_rollup", "r");
+    char linha[128];
+    long total = -1, valor;
+    
+    if (arquivo == NULL) {
+        return -1;
+    }
+    while (fgets(linha, sizeof(linha), arquivo) != NULL) {
+        if (sscanf(linha, "AnonHugePages: %ld", &valor) == 1 ||
+            sscanf(linha, "Private_Hugetlb: %ld", &valor) == 1) {
+            total = (total < 0 ? 0 : total) + valor;
+        }
+    }
+    fclose(arquivo);
+    return total;
+}
+
+// Repetições padrão de cada varredura em --medir-varredura
+#define REPETICOES_VARREDURA 20
+
+// Repetições de --medir-varredura (0 = não medir)
+int repeticoesVarredura = 0;
+
+/*
+ * Função para comparar os modos de alocação nas varreduras de missão
+ * 
+ * Parâmetros:
+ * - origem: mapa carregado (copiado para cada modo)
+ * - tamanho: número de territórios
+ * - repeticoes: vezes que cada varredura é repetida
+ * 
+ * Para cada modo, aloca uma cópia do mapa e o seu índice, e mede:
+ * - a alocação com primeiro toque, cópia e construção do índice
+ * - a varredura estatística paralela (placar e missões de todas as cores)
+ * - a verificação das seis missões de uma cor a partir dessa varredura,
+ *   como faz o placar
+ */
+void medirVarreduras(const struct Territorio* origem, int tamanho, int repeticoes) {
+    static const char* nomesModos[] = { "calloc", "transparentes", "MAP_HUGETLB" };
+    int modoOriginal = modoAlocacao;
+    
+    printf("\n=================================================\n");
+    printf("   VARREDURAS DE MISSÃO: %d territórios, %d trechos\n",
+           tamanho, trechosDeVarredura(tamanho));
+    printf("=================================================\n");
+    printf("%-17s %11s %13s %13s %12s\n",
+           "Páginas", "Preparo (s)", "Placar ns/t", "Missões ns/t", "Grandes KiB");
+    
+    for (int modo = ALOCACAO_PADRAO; modo <= ALOCACAO_EXPLICITA; modo++) {
+        struct EstatisticasMapa estatisticas;
+        volatile int cumpridas = 0;  // Impede que o compilador descarte as verificações
+        
+        modoAlocacao = modo;
+        double inicio = relogioSegundos();
+        struct Territorio* copia = (struct Territorio*)alocarVetorGrande(tamanho, sizeof(struct Territorio));
+        if (copia == NULL) {
+            printf("%-17s sem memória\n", nomesModos[modo]);
+            continue;
+        }
+        memcpy(copia, origem, tamanho * sizeof(struct Territorio));
+        if (!construirIndiceAlvos(copia, tamanho)) {
+            printf("%-17s sem memória para o índice\n", nomesModos[modo]);
+            liberarVetorGrande(copia);
+            continue;
+        }
+        double preparo = relogioSegundos() - inicio;
+        long grandes = paginasGrandesEmUso();
+        
+        inicio = relogioSegundos();
+        for (int r = 0; r < repeticoes; r++) {
+            calcularEstatisticas(&estatisticas);
+        }
+        double placar = relogioSegundos() - inicio;
+        
+        // Uma varredura em trechos por repetição, seguida das seis missões
+        inicio = relogioSegundos();
+        for (int r = 0; r < repeticoes; r++) {
+            calcularEstatisticas(&estatisticas);
+            for (int m = 0; m < TOTAL_MISSOES; m++) {
+                cumpridas += verificarMissaoPorEstatisticas(missoesPredefinidas[m], &estatisticas,
+                                                            r % totalCores);
             }
         }
-        return territoriosControlados >= 3;
+        double missoes = relogioSegundos() - inicio;
+        
+        printf("%-17s %11.3f %13.2f %13.2f %12ld\n", nomesModos[modo], preparo,
+               placar * 1e9 / ((double)repeticoes * tamanho),
+               missoes * 1e9 / ((double)repeticoes * tamanho), grandes);
+        
+        liberarIndiceAlvos();
+        liberarVetorGrande(copia);
+    }
+    
+    modoAlocacao = modoOriginal;
+    printf("=================================================\n");
+}
+
+/*
+ * Definição da estrutura PartidaFazenda
+ * 
+ * Vaga de uma partida na região compartilhada da fazenda de simulação.
+ * O processo que joga a partida preenche os campos e só então publica
+ * 'concluida' (liberação), para que o pai nunca leia uma vaga pela metade.
+ */
+struct PartidaFazenda {
+    atomic_int concluida;  // 1 quando os campos abaixo estão prontos
+    atomic_int dono;       // PID do trabalhador que reservou a partida
+    int devolvida;         // 1 se já voltou à fila uma vez (só o pai escreve)
+    int processo;          // Trabalhador que jogou a partida
+    int vencedor;          // Identificador da cor vencedora (-1 = sem vencedor)
+    int missao;            // Missão do vencedor (-1 = sem vencedor)
+    int rodadas;
+    long long ataques;
+};
+
+/*
+ * Definição da estrutura RegiaoFazenda
+ * 
+ * Memória compartilhada entre o pai e os processos trabalhadores (mmap
+ * anônimo com MAP_SHARED, herdado no fork). As partidas são distribuídas
+ * por um contador atômico e os totais são acumulados atomicamente, sem
+ * travas: o pai lê os totais enquanto a fazenda roda.
+ * 
+ * Partidas de um trabalhador que caiu voltam em 'devolvidas' (no fim da
+ * mesma região), escritas só pelo pai e publicadas por 'totalDevolvidas'.
+ */
+struct RegiaoFazenda {
+    int totalPartidas;
+    atomic_int proximaPartida;                 // Próxima partida a distribuir
+    int* devolvidas;                           // Partidas a jogar de novo
+    atomic_int totalDevolvidas;                // Devolvidas já publicadas
+    atomic_int proximaDevolvida;               // Próxima devolvida a distribuir
+    atomic_int concluidas;                     // Partidas terminadas
+    atomic_llong vitorias[MAX_CORES];          // Vitórias por cor
+    atomic_llong vitoriasMissao[TOTAL_MISSOES]; // Vitórias por missão
+    atomic_llong semVencedor;                  // Partidas sem vencedor
+    atomic_llong ataques;                      // Ataques de todas as partidas
+    struct PartidaFazenda partidas[];          // Uma vaga por partida
+};
+
+// Intervalo entre as parciais exibidas pelo pai
+#define INTERVALO_FAZENDA_S 0.5
+
+// Intervalo entre as verificações do pai (trabalhadores que terminaram)
+#define ESPERA_FAZENDA_US 20000
+
+// Processos trabalhadores (--fazenda=N; 0 = desligada) e partidas a jogar
+int processosFazenda = 0;
+int partidasFazenda = 1000;
+
+/*
+ * Função para reservar a próxima partida de um trabalhador
+ * 
+ * Retorna:
+ * - Número da partida (as devolvidas têm prioridade)
+ * - totalPartidas ou mais quando não há mais partidas
+ */
+int reservarPartidaFazenda(struct RegiaoFazenda* regiao) {
+    int k = atomic_load(&regiao->proximaDevolvida);
+    while (k < atomic_load_explicit(&regiao->totalDevolvidas, memory_order_acquire)) {
+        if (atomic_compare_exchange_weak(&regiao->proximaDevolvida, &k, k + 1)) {
+            return regiao->devolvidas[k];
+        }
+    }
+    return atomic_fetch_add(&regiao->proximaPartida, 1);
+}
+
+/*
+ * Função executada por cada processo trabalhador da fazenda
+ * 
+ * Parâmetros:
+ * - regiao: região compartilhada
+ * - processo: número do trabalhador
+ * - original: mapa inicial (cópia herdada do pai)
+ * - tamanho: número de territórios
+ * 
+ * Retorna:
+ * - 1 se o trabalhador jogou todas as partidas que reservou
+ * - 0 em caso de falta de memória (o pai devolve a partida reservada)
+ * 
+ * Cada partida parte de uma cópia do mapa original, com um gerador
+ * semeado só pela semente da fazenda e pelo número da partida: o resultado
+ * não depende de qual processo a jogou.
+ */
+int trabalharNaFazenda(struct RegiaoFazenda* regiao, int processo,
+                       const struct Territorio* original, int tamanho) {
+    struct Territorio* mapa = (struct Territorio*)alocarVetorGrande(tamanho, sizeof(struct Territorio));
+    pid_t eu = getpid();
+    int sucesso = 1;
+    
+    if (mapa == NULL) {
+        return 0;
+    }
+    
+    while (1) {
+        int partida = reservarPartidaFazenda(regiao);
+        if (partida >= regiao->totalPartidas) {
+            break;
+        }
+        
+        struct GeradorDados gerador;
+        struct ResultadoPartida resultado;
+        struct PartidaFazenda* vaga = &regiao->partidas[partida];
+        
+        atomic_store(&vaga->dono, (int)eu);
+        memcpy(mapa, original, tamanho * sizeof(struct Territorio));
+        if (!construirIndiceAlvos(mapa, tamanho)) {
+            sucesso = 0;
+            break;
+        }
+        iniciarGerador(&gerador, sementePartida ^ misturarBits((uint64_t)partida + 1));
+        simularPartida(mapa, tamanho, &gerador, MAX_RODADAS, &resultado);
+        
+        vaga->processo = processo;
+        vaga->vencedor = resultado.vencedor;
+        vaga->missao = resultado.vencedor >= 0 ? resultado.missaoDe[resultado.vencedor] : -1;
+        vaga->rodadas = resultado.rodadas;
+        vaga->ataques = resultado.ataques;
+        
+        if (resultado.vencedor >= 0) {
+            atomic_fetch_add(&regiao->vitorias[resultado.vencedor], 1);
+            atomic_fetch_add(&regiao->vitoriasMissao[vaga->missao], 1);
+        } else {
+            atomic_fetch_add(&regiao->semVencedor, 1);
+        }
+        atomic_fetch_add(&regiao->ataques, resultado.ataques);
+        atomic_store_explicit(&vaga->concluida, 1, memory_order_release);
+        atomic_fetch_add(&regiao->concluidas, 1);
+    }
+    
+    liberarIndiceAlvos();
+    liberarVetorGrande(mapa);
+    return sucesso;
+}
+
+/*
+ * Função para devolver à fila as partidas de um trabalhador que caiu
+ * 
+ * Parâmetros:
+ * - regiao: região compartilhada
+ * - pid: trabalhador que terminou com erro
+ * 
+ * Retorna:
+ * - Número de partidas devolvidas
+ * 
+ * Cada partida volta à fila uma vez só: se derrubar também o trabalhador
+ * seguinte, é dada como perdida em vez de consumir todas as substituições.
+ */
+int devolverPartidas(struct RegiaoFazenda* regiao, pid_t pid) {
+    int reservadas = atomic_load(&regiao->proximaPartida);
+    int total = atomic_load(&regiao->totalDevolvidas);
+    int devolvidas = 0;
+    
+    if (reservadas > regiao->totalPartidas) reservadas = regiao->totalPartidas;
+    for (int i = 0; i < reservadas; i++) {
+        struct PartidaFazenda* vaga = &regiao->partidas[i];
+        if (atomic_load(&vaga->dono) == (int)pid && !vaga->devolvida &&
+            !atomic_load_explicit(&vaga->concluida, memory_order_acquire)) {
+            vaga->devolvida = 1;
+            regiao->devolvidas[total + devolvidas++] = i;
+        }
+    }
+    atomic_store_explicit(&regiao->totalDevolvidas, total + devolvidas, memory_order_release);
+    return devolvidas;
+}
+
+/*
+ * Função para exibir as taxas de vitória acumuladas na região
+ * 
+ * Parâmetros:
+ * - regiao: região compartilhada
+ * - concluidas: partidas terminadas até agora
+ */
+void exibirParcialFazenda(struct RegiaoFazenda* regiao, int concluidas) {
+    printf("[%d/%d]", concluidas, regiao->totalPartidas);
+    for (int c = 0; c < totalCores; c++) {
+        long long vitorias = atomic_load(&regiao->vitorias[c]);
+        if (vitorias > 0) {
+            printf(" %s %.1f%%", coresRegistradas[c], 100.0 * vitorias / concluidas);
+        }
+    }
+    long long semVencedor = atomic_load(&regiao->semVencedor);
+    if (semVencedor > 0) {
+        printf(" | sem vencedor %.1f%%", 100.0 * semVencedor / concluidas);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+/*
+ * Função para criar um processo trabalhador da fazenda
+ * 
+ * Retorna:
+ * - PID do trabalhador
+ * - -1 se o fork falhou
+ */
+pid_t iniciarTrabalhador(struct RegiaoFazenda* regiao, int processo,
+                         const struct Territorio* mapa, int tamanho) {
+    fflush(stdout);  // O filho não pode herdar saída pendente e repeti-la
+    pid_t pid = fork();
+    
+    if (pid == 0) {
+        // Sem atexit: relatórios e liberações são do pai
+        _exit(trabalharNaFazenda(regiao, processo, mapa, tamanho) ? 0 : 1);
+    }
+    return pid;
+}
+
+/*
+ * Função para rodar partidas automáticas em vários processos
+ * 
+ * Parâmetros:
+ * - mapa: mapa inicial (deve estar indexado)
+ * - tamanho: número de territórios
+ * - numProcessos: processos trabalhadores
+ * - totalPartidas: partidas a jogar
+ * 
+ * Retorna:
+ * - 1 se todas as partidas foram jogadas
+ * - 0 caso contrário
+ * 
+ * Cada trabalhador tem o próprio espaço de endereçamento (globais como
+ * missaoJogador e geradorAtaques incluídas): um trabalhador que cai não
+ * derruba os outros e é substituído enquanto houver partidas a distribuir.
+ * A partida que ele estava jogando volta à fila uma vez; as que ainda assim
+ * não terminam ficam de fora do placar final.
+ */
+int executarFazenda(struct Territorio* mapa, int tamanho, int numProcessos, int totalPartidas) {
+    size_t bytes = sizeof(struct RegiaoFazenda) + (size_t)totalPartidas * sizeof(struct PartidaFazenda) +
+                   (size_t)totalPartidas * sizeof(int);
+    struct RegiaoFazenda* regiao = (struct RegiaoFazenda*)mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (regiao == MAP_FAILED) {
+        printf("Erro: Não foi possível criar a memória compartilhada da fazenda!\n");
+        return 0;
+    }
+    regiao->totalPartidas = totalPartidas;  // O resto já vem zerado do mmap
+    regiao->devolvidas = (int*)&regiao->partidas[totalPartidas];
+    
+    printf("\n=================================================\n");
+    printf("   FAZENDA: %d partidas em %d processos (semente %llu)\n",
+           totalPartidas, numProcessos, (unsigned long long)sementePartida);
+    printf("=================================================\n");
+    
+    double inicio = relogioSegundos();
+    int vivos = 0, falhas = 0;
+    
+    for (int p = 0; p < numProcessos; p++) {
+        if (iniciarTrabalhador(regiao, p, mapa, tamanho) > 0) {
+            vivos++;
+        }
+    }
+    if (vivos == 0) {
+        printf("Erro: Não foi possível criar os processos da fazenda!\n");
+        munmap(regiao, bytes);
+        return 0;
+    }
+    
+    int ultimaExibida = 0;
+    int proximoProcesso = numProcessos;
+    double proximaParcial = inicio + INTERVALO_FAZENDA_S;
+    while (vivos > 0) {
+        usleep(ESPERA_FAZENDA_US);
+        
+        int estado;
+        pid_t pid;
+        while ((pid = waitpid(-1, &estado, WNOHANG)) > 0) {
+            vivos--;
+            if (WIFEXITED(estado) && WEXITSTATUS(estado) == 0) {
+                continue;
+            }
+            falhas++;
+            printf("Aviso: trabalhador %d terminou com %s %d; %d partida(s) voltaram à fila.\n",
+                   (int)pid, WIFSIGNALED(estado) ? "sinal" : "código",
+                   WIFSIGNALED(estado) ? WTERMSIG(estado) : WEXITSTATUS(estado),
+                   devolverPartidas(regiao, pid));
+            int pendentes = atomic_load(&regiao->proximaPartida) < totalPartidas ||
+                            atomic_load(&regiao->proximaDevolvida) < atomic_load(&regiao->totalDevolvidas);
+            if (pendentes && falhas <= numProcessos &&
+                iniciarTrabalhador(regiao, proximoProcesso++, mapa, tamanho) > 0) {
+                vivos++;
+            }
+        }
+        
+        int concluidas = atomic_load(&regiao->concluidas);
+        if (concluidas > ultimaExibida && (vivos == 0 || relogioSegundos() >= proximaParcial)) {
+            exibirParcialFazenda(regiao, concluidas);
+            ultimaExibida = concluidas;
+            proximaParcial = relogioSegundos() + INTERVALO_FAZENDA_S;
+        }
+    }
+    
+    double segundos = relogioSegundos() - inicio;
+    int concluidas = atomic_load(&regiao->concluidas);
+    long long rodadas = 0;
+    for (int i = 0; i < totalPartidas; i++) {
+        if (atomic_load_explicit(&regiao->partidas[i].concluida, memory_order_acquire)) {
+            rodadas += regiao->partidas[i].rodadas;
+        }
+    }
+    
+    printf("-------------------------------------------------\n");
+    printf("Partidas: %d de %d | Tempo: %.3f s | %.1f partidas/s\n", concluidas, totalPartidas,
+           segundos, segundos > 0 ? concluidas / segundos : 0.0);
+    if (concluidas > 0) {
+        printf("Média: %.1f rodadas e %.1f ataques por partida\n", (double)rodadas / concluidas,
+               (double)atomic_load(&regiao->ataques) / concluidas);
+        for (int m = 0; m < TOTAL_MISSOES; m++) {
+            long long vitorias = atomic_load(&regiao->vitoriasMissao[m]);
+            printf("    Vitórias com \"%s\": %.1f%%\n", missoesPredefinidas[m],
+                   100.0 * vitorias / concluidas);
+        }
+    }
+    if (falhas > 0) {
+        printf("Trabalhadores perdidos: %d\n", falhas);
+    }
+    printf("=================================================\n");
+    
+    munmap(regiao, bytes);
+    return concluidas == totalPartidas;
+}
+
+/*
+ * Bateria de regressão com partidas de referência
+ * 
+ * Cada cenário gera um mapa com semente fixa e joga uma partida automática
+ * pelo caminho real do jogo (validarAtaque, atacar e verificação de
+ * missões). O estado final é resumido em um espalhamento que precisa bater
+ * com o valor de referência do cenário: qualquer motor novo de combate, de
+ * índice ou de geração tem de reproduzir as regras atuais exatamente.
+ * Quando uma regra muda de propósito, as referências são trocadas pelos
+ * valores obtidos.
+ * 
+ * Cada partida é repetida para medir vazão (ataques por segundo) e latência
+ * (melhor, mediana e pior partida). Com uma base de desempenho gravada, a
+ * bateria falha se a melhor partida de algum cenário piorar além da
+ * tolerância.
+ */
+#define REPETICOES_REGRESSAO 5
+
+// Tempo mínimo somado de cada medição, em segundos
+#define TEMPO_MINIMO_REGRESSAO 0.05
+
+// Piora aceita em relação à base, em porcentagem
+#define TOLERANCIA_REGRESSAO 25.0
+
+// Partidas por cenário (--regressao[=R]; 0 = bateria desligada)
+int repeticoesRegressao = 0;
+
+// Arquivo da base de desempenho (--base-desempenho) e se deve regravá-lo
+const char* caminhoBaseDesempenho = NULL;
+int gravarBaseDesempenho = 0;
+
+// Piora aceita em porcentagem (--tolerancia)
+double toleranciaRegressao = TOLERANCIA_REGRESSAO;
+
+// Conferência extra feita antes da partida de um cenário
+#define CONFERIR_NADA 0
+#define CONFERIR_LOTE_SERIAL 1   // Turnos em lote contra ataques um a um
+#define CONFERIR_VIABILIDADE 2   // Análise incremental contra uma refeita do zero
+
+/*
+ * Definição da estrutura CenarioRegressao
+ * 
+ * Mapa gerado, regras da partida e espalhamento esperado do estado final:
+ * - lote: threads do modo em lote (0 = ataques um a um)
+ * - conferencia: CONFERIR_* feita antes da partida, rodada a rodada
+ * - missao: missão de todas as cores (-1 = sorteada; as sorteadas costumam
+ *   já estar cumpridas em mapas gerados, e a partida acaba no 1º ataque)
+ * - fronteiras: 0 descarta a adjacência (qualquer um ataca qualquer um)
+ */
+struct CenarioRegressao {
+    const char* nome;
+    int territorios;
+    int cores;
+    int distribuicaoCores;
+    int distribuicaoTropas;
+    int tropasMaximas;
+    uint64_t semente;
+    int combate;
+    int lote;
+    int conferencia;
+    int ataquesPorRodada;
+    int fronteiras;
+    int missao;
+    int maxRodadas;
+    uint64_t espalhamentoEsperado;
+};
+
+// Cenários de referência
+const struct CenarioRegressao cenariosRegressao[] = {
+    { "pequeno-sorteio", 30, 3, CORES_POR_REGIAO, TROPAS_UNIFORMES, 10, 9,
+      COMBATE_DADO_UNICO, 0, CONFERIR_NADA, 1, 1, -1, MAX_RODADAS, 0xe8958fe025cc04abULL },
+    { "pequeno-classico", 30, 3, CORES_POR_REGIAO, TROPAS_UNIFORMES, 10, 9,
+      COMBATE_CLASSICO, 0, CONFERIR_NADA, 1, 1, MISSAO_ELIMINAR_VERMELHAS, MAX_RODADAS, 0x468833bb5fe6f1c8ULL },
+    { "sem-fronteiras", 200, 4, CORES_UNIFORMES, TROPAS_UNIFORMES, 10, 31,
+      COMBATE_CLASSICO, 0, CONFERIR_NADA, 1, 0, MISSAO_REGIAO, MAX_RODADAS, 0x162f04a202355989ULL },
+    { "medio-vermelhas", 2000, 5, CORES_UNIFORMES, TROPAS_EXPONENCIAIS, 50, 17,
+      COMBATE_DADO_UNICO, 0, CONFERIR_NADA, 2, 1, MISSAO_ELIMINAR_VERMELHAS, MAX_RODADAS, 0x8ce4c83852adebbfULL },
+    { "medio-lote", 2000, 5, CORES_POR_REGIAO, TROPAS_UNIFORMES, 10, 23,
+      COMBATE_CLASSICO, 2, CONFERIR_NADA, 4, 1, MISSAO_REGIAO, MAX_RODADAS, 0xc71aecedb4346afdULL },
+    { "grande", 100000, 6, CORES_POR_REGIAO, TROPAS_UNIFORMES, 10, 41,
+      COMBATE_DADO_UNICO, 0, CONFERIR_NADA, 8, 1, MISSAO_REGIAO, 20, 0x42ebddac1bb758b1ULL },
+    { "lote-serial", 2000, 4, CORES_POR_REGIAO, TROPAS_EXPONENCIAIS, 30, 29,
+      COMBATE_CLASSICO, 4, CONFERIR_LOTE_SERIAL, 16, 1, MISSAO_REGIAO, 60, 0x4e91bfd643388f78ULL },
+    { "viabilidade", 900, 4, CORES_POR_REGIAO, TROPAS_UNIFORMES, 10, 37,
+      COMBATE_CLASSICO, 0, CONFERIR_VIABILIDADE, 4, 1, MISSAO_REGIAO, 40, 0xe6e655e0629c3cd9ULL },
+};
+
+#define TOTAL_CENARIOS ((int)(sizeof(cenariosRegressao) / sizeof(cenariosRegressao[0])))
+
+/*
+ * Definição da estrutura DesempenhoCenario
+ * 
+ * Uma linha da base de desempenho (ou da medição atual)
+ */
+struct DesempenhoCenario {
+    char nome[32];
+    double ataquesPorSegundo;
+    double melhorMs;
+    double medianaMs;
+    double piorMs;
+    long long ataques;  // Ataques por partida (só na medição atual)
+};
+
+/*
+ * Função para resumir o estado final de uma partida
+ * 
+ * Parâmetros:
+ * - mapa: territórios ao fim da partida
+ * - tamanho: número de territórios
+ * - resultado: vencedor, rodadas e ataques da partida
+ * 
+ * Retorna:
+ * - Espalhamento de 64 bits de dono e tropas de cada território, em ordem,
+ *   e do resumo da partida
+ */
+uint64_t espalharEstadoFinal(const struct Territorio* mapa, int tamanho,
+                             const struct ResultadoPartida* resultado) {
+    uint64_t h = misturarBits((uint64_t)tamanho);
+    
+    for (int i = 0; i < tamanho; i++) {
+        uint64_t territorio = (uint64_t)espalharNome(mapa[i].cor) << 32 | (uint32_t)mapa[i].tropas;
+        h = misturarBits(h ^ territorio);
+    }
+    h = misturarBits(h ^ (uint64_t)(resultado->vencedor < 0 ? 0 :
+                                    espalharNome(coresRegistradas[resultado->vencedor])));
+    h = misturarBits(h ^ (uint64_t)resultado->rodadas);
+    return misturarBits(h ^ (uint64_t)resultado->ataques);
+}
+
+/*
+ * Função para gerar e carregar o mapa de um cenário
+ * 
+ * Parâmetros:
+ * - cenario: cenário a preparar
+ * - tamanho: ponteiro que recebe o número de territórios
+ * 
+ * Retorna:
+ * - Mapa carregado (com a adjacência ativa se o cenário usa fronteiras)
+ * - NULL em caso de erro
+ * 
+ * O mapa passa pelo gerador e pelo arquivo, como um mapa de --gerar-mapa.
+ */
+struct Territorio* prepararCenario(const struct CenarioRegressao* cenario, int* tamanho) {
+    char caminho[] = "/tmp/war-regressao-XXXXXX";
+    int arquivo = mkstemp(caminho);
+    if (arquivo < 0) {
+        printf("Erro: Não foi possível criar o arquivo temporário do cenário '%s'!\n", cenario->nome);
+        return NULL;
+    }
+    close(arquivo);
+    
+    struct ParametrosGerador parametros = parametrosGerador;
+    parametros.quantidade = cenario->territorios;
+    parametros.cores = cenario->cores;
+    parametros.regioes = cenario->territorios / 100 > 0 ? cenario->territorios / 100 : 1;
+    parametros.distribuicaoCores = cenario->distribuicaoCores;
+    parametros.distribuicaoTropas = cenario->distribuicaoTropas;
+    parametros.tropasMaximas = cenario->tropasMaximas;
+    parametros.semente = cenario->semente;
+    parametros.numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    
+    struct Territorio* mapa = NULL;
+    if (gerarMapa(caminho, &parametros)) {
+        mapa = carregarMapa(caminho, tamanho);
     }
+    unlink(caminho);
     
-    // Missão 6: "Controlar todos os territórios de uma região"
-    if (strcmp(missao, "Controlar todos os territórios de uma região") == 0) {
-        // Simplificação: controlar metade dos territórios
-        int territoriosControlados = 0;
-        
-        for (int i = 0; i < tamanho; i++) {
-            if (strcmp(mapa[i].cor, corJogador) == 0) {
-                territoriosControlados++;
-            }
-        }
-        return territoriosControlados >= (tamanho / 2);
+    if (mapa != NULL && !cenario->fronteiras) {
+        liberarAdjacencia();
     }
-    
-    return 0; // Missão não reconhecida ou não cumprida
+    return mapa;
 }
 
 /*
- * Função para cadastrar os territórios usando ponteiros
+ * Função para ler a base de desempenho
  * 
  * Parâmetros:
- * - mapa: ponteiro para o vetor de territórios
- * - quantidade: número de territórios a serem cadastrados
+ * - caminho: arquivo com uma linha "nome ataques/s melhor-ms mediana-ms pior-ms"
+ *   por cenário
+ * - base: vetor que recebe as linhas (TOTAL_CENARIOS posições)
+ * 
+ * Retorna:
+ * - Número de linhas lidas (0 se o arquivo não existe)
  */
-void cadastrarTerritorios(struct Territorio* mapa, int quantidade) {
-    printf("\n=================================================\n");
-    printf("           CADASTRO DE TERRITÓRIOS\n");
-    printf("=================================================\n");
+int lerBaseDesempenho(const char* caminho, struct DesempenhoCenario* base) {
+    FILE* arquivo = fopen(caminho, "r");
+    if (arquivo == NULL) {
+        return 0;
+    }
     
-    for (int i = 0; i < quantidade; i++) {
-        printf("\n--- Cadastro do Território %d ---\n", i + 1);
-        
-        // Entrada do nome do território usando ponteiro
-        printf("Digite o nome do território: ");
-        scanf("%29s", (mapa + i)->nome);  // Acesso via ponteiro
-        
-        // Entrada da cor do exército usando ponteiro
-        printf("Digite a cor do exército: ");
-        scanf("%9s", (mapa + i)->cor);    // Acesso via ponteiro
-        
-        // Entrada da quantidade de tropas usando ponteiro
-        printf("Digite a quantidade de tropas: ");
-        scanf("%d", &((mapa + i)->tropas)); // Acesso via ponteiro
-        
-        printf("Território '%s' cadastrado com sucesso!\n", (mapa + i)->nome);
+    char linha[256];
+    int total = 0;
+    while (total < TOTAL_CENARIOS && fgets(linha, sizeof(linha), arquivo) != NULL) {
+        struct DesempenhoCenario* item = &base[total];
+        if (linha[0] != '#' &&
+            sscanf(linha, "%31s %lf %lf %lf %lf", item->nome, &item->ataquesPorSegundo,
+                   &item->melhorMs, &item->medianaMs, &item->piorMs) == 5) {
+            total++;
+        }
     }
+    fclose(arquivo);
+    return total;
 }
 
 /*
- * Função para exibir todos os territórios usando ponteiros
+ * Função para gravar a base de desempenho
  * 
- * Parâmetros:
- * - mapa: ponteiro para o vetor de territórios
- * - quantidade: número de territórios a serem exibidos
+ * Retorna:
+ * - 1 se gravou, 0 em caso de erro
  */
-void exibirTerritorios(struct Territorio* mapa, int quantidade) {
-    printf("\n=================================================\n");
-    printf("           MAPA DE TERRITÓRIOS\n");
-    printf("=================================================\n");
-    
-    for (int i = 0; i < quantidade; i++) {
-        printf("\n[%d] Território: %s\n", i + 1, (mapa + i)->nome);
-        printf("    Controlado por: %s\n", (mapa + i)->cor);
-        printf("    Tropas: %d\n", (mapa + i)->tropas);
+int gravarBase(const char* caminho, const struct DesempenhoCenario* medidos, int total) {
+    FILE* arquivo = fopen(caminho, "w");
+    if (arquivo == NULL) {
+        printf("Erro: Não foi possível gravar a base de desempenho '%s'!\n", caminho);
+        return 0;
     }
     
-    printf("\n=================================================\n");
+    fprintf(arquivo, "# cenario ataques/s melhor-ms mediana-ms pior-ms\n");
+    for (int k = 0; k < total; k++) {
+        fprintf(arquivo, "%s %.1f %.4f %.4f %.4f\n", medidos[k].nome, medidos[k].ataquesPorSegundo,
+                medidos[k].melhorMs, medidos[k].medianaMs, medidos[k].piorMs);
+    }
+    fclose(arquivo);
+    printf("Base de desempenho gravada em '%s'.\n", caminho);
+    return 1;
 }
 
 /*
- * Função para selecionar um território para ataque ou defesa
+ * Função para conferir o modo em lote contra ataques um a um
  * 
  * Parâmetros:
- * - mapa: ponteiro para o vetor de territórios
- * - quantidade: número total de territórios
- * - acao: string indicando se é para "atacar" ou "defender"
+ * - original: mapa inicial do cenário
+ * - tamanho: número de territórios
+ * - cenario: cenário com lote, ataques por rodada e rodadas
  * 
  * Retorna:
- * - Índice do território selecionado (0-based)
- * - -1 em caso de seleção inválida
+ * - 1 se todos os turnos coincidiram
+ * - 0 caso contrário (ou em caso de erro)
+ * 
+ * Em cada rodada, todas as cores planejam sobre o mesmo estado e o turno é
+ * aplicado em lote no mapa do jogo. Uma cópia do estado anterior recebe os
+ * mesmos ataques com atacar, na ordem de submissão e com o gerador que cada
+ * um teve no lote. Tropas, donos e os dois índices de alvos têm de bater.
  */
-int selecionarTerritorio(struct Territorio* mapa, int quantidade, char* acao) {
-    int escolha;
+int conferirLoteSerial(const struct Territorio* original, int tamanho,
+                       const struct CenarioRegressao* cenario) {
+    struct Territorio* mapa = alocarTerritorios(tamanho);
+    struct Territorio* copia = alocarTerritorios(tamanho);
+    struct AtaqueLote* ataques =
+        (struct AtaqueLote*)malloc((size_t)MAX_CORES * cenario->ataquesPorRodada * sizeof(struct AtaqueLote));
+    struct GeradorDados* geradorAnterior = geradorAtaques;
+    int silencioAnterior = modoSilencioso;
+    struct GeradorDados gerador;
+    int confere = 1;
     
-    printf("\nSelecione um território para %s (1-%d): ", acao, quantidade);
-    scanf("%d", &escolha);
+    if (mapa == NULL || copia == NULL || ataques == NULL) {
+        printf("Erro: Memória insuficiente para conferir o cenário '%s'!\n", cenario->nome);
+        confere = 0;
+    } else {
+        memcpy(mapa, original, tamanho * sizeof(struct Territorio));
+    }
+    iniciarGerador(&gerador, cenario->semente);
+    modoSilencioso = 1;
     
-    // Validação da entrada
-    if (escolha < 1 || escolha > quantidade) {
-        printf("Erro: Seleção inválida! Escolha entre 1 e %d.\n", quantidade);
-        return -1;
+    for (int rodada = 0; confere && rodada < cenario->maxRodadas; rodada++) {
+        if (!construirIndiceAlvos(mapa, tamanho)) {
+            printf("Erro: Memória insuficiente para o índice do cenário '%s'!\n", cenario->nome);
+            confere = 0;
+            break;
+        }
+        
+        int total = 0;
+        for (int c = 0; c < totalCores; c++) {
+            if (indiceAlvos.maisFracos[c].tamanho > 0) {
+                total += planejarAtaques(c, cenario->ataquesPorRodada, ataques + total);
+            }
+        }
+        
+        uint64_t semente = proximoAleatorio(&gerador);
+        memcpy(copia, mapa, tamanho * sizeof(struct Territorio));
+        int aplicados = aplicarLoteAtaques(mapa, tamanho, ataques, total, semente, cenario->lote);
+        if (aplicados <= 0) {
+            break;  // Ninguém mais consegue atacar
+        }
+        int loteConfere = verificarIndiceAlvos();
+        
+        // O mesmo turno, um ataque por vez, com o gerador de cada ataque
+        if (!construirIndiceAlvos(copia, tamanho)) {
+            printf("Erro: Memória insuficiente para o índice do cenário '%s'!\n", cenario->nome);
+            confere = 0;
+            break;
+        }
+        int validos = 0;
+        for (int a = 0; a < total; a++) {
+            struct GeradorDados geradorAtaque;
+            struct Territorio* atacante = &copia[ataques[a].atacante];
+            struct Territorio* defensor = &copia[ataques[a].defensor];
+            
+            if (!validarAtaque(atacante, defensor)) {
+                continue;
+            }
+            iniciarGerador(&geradorAtaque, semente ^ ((uint64_t)(a + 1) * 0xD1B54A32D192ED03ULL));
+            geradorAtaques = &geradorAtaque;
+            atacar(atacante, defensor);
+            validos++;
+        }
+        geradorAtaques = geradorAnterior;
+        int serialConfere = verificarIndiceAlvos();
+        
+        int diferentes = 0;
+        for (int i = 0; i < tamanho; i++) {
+            diferentes += mapa[i].tropas != copia[i].tropas || strcmp(mapa[i].cor, copia[i].cor) != 0;
+        }
+        if (!loteConfere || !serialConfere || validos != aplicados || diferentes > 0) {
+            printf("Erro: Cenário '%s', rodada %d: lote e ataques um a um divergem "
+                   "(%d territórios diferentes, %d e %d ataques, índices %s e %s)!\n",
+                   cenario->nome, rodada + 1, diferentes, aplicados, validos,
+                   loteConfere ? "ok" : "inconsistente", serialConfere ? "ok" : "inconsistente");
+            confere = 0;
+        }
     }
     
-    return escolha - 1; // Retorna índice 0-based
+    modoSilencioso = silencioAnterior;
+    liberarIndiceAlvos();
+    free(ataques);
+    liberarVetorGrande(copia);
+    liberarVetorGrande(mapa);
+    return confere;
 }
 
 /*
- * Função para simular um ataque entre territórios
+ * Função para conferir a análise de viabilidade incremental
  * 
  * Parâmetros:
- * - atacante: ponteiro para o território atacante
- * - defensor: ponteiro para o território defensor
+ * - original: mapa inicial do cenário
+ * - tamanho: número de territórios
+ * - cenario: cenário com ataques por rodada e rodadas
  * 
- * Lógica:
- * - Simula rolagem de dados (1-6) para atacante e defensor
- * - Se atacante vencer: defensor muda de cor e recebe metade das tropas
- * - Se defensor vencer: atacante perde uma tropa
+ * Retorna:
+ * - 1 se a análise em dia bateu com a refeita do zero em todas as rodadas
+ * - 0 caso contrário (ou em caso de erro)
+ * 
+ * Em cada rodada, uma cor planeja e faz os seus ataques com atacar; a
+ * análise é posta em dia como no comando viabilidade, só refazendo as cores
+ * afetadas, e comparada com a de todas as cores recalculadas.
  */
-void atacar(struct Territorio* atacante, struct Territorio* defensor) {
-    // Simulação de dados de batalha (1 a 6)
-    int dadoAtacante = rand() % 6 + 1;
-    int dadoDefensor = rand() % 6 + 1;
+int conferirViabilidade(const struct Territorio* original, int tamanho,
+                        const struct CenarioRegressao* cenario) {
+    static struct ViabilidadeMissao incremental[MAX_CORES][TOTAL_MISSOES];
+    struct Territorio* mapa = alocarTerritorios(tamanho);
+    struct AtaqueLote* ataques = (struct AtaqueLote*)malloc(cenario->ataquesPorRodada * sizeof(struct AtaqueLote));
+    struct GeradorDados* geradorAnterior = geradorAtaques;
+    int silencioAnterior = modoSilencioso;
+    struct GeradorDados gerador;
+    int confere = 1;
     
-    printf("\n=================================================\n");
-    printf("                SIMULAÇÃO DE BATALHA\n");
-    printf("=================================================\n");
-    printf("Atacante: %s (%s) - Dado: %d\n", atacante->nome, atacante->cor, dadoAtacante);
-    printf("Defensor: %s (%s) - Dado: %d\n", defensor->nome, defensor->cor, dadoDefensor);
-    printf("-------------------------------------------------\n");
+    if (mapa == NULL || ataques == NULL) {
+        printf("Erro: Memória insuficiente para conferir o cenário '%s'!\n", cenario->nome);
+        confere = 0;
+    } else {
+        memcpy(mapa, original, tamanho * sizeof(struct Territorio));
+        if (!construirIndiceAlvos(mapa, tamanho) || atualizarViabilidade() < 0) {
+            printf("Erro: Memória insuficiente para a análise do cenário '%s'!\n", cenario->nome);
+            confere = 0;
+        }
+    }
+    iniciarGerador(&gerador, cenario->semente);
+    geradorAtaques = &gerador;
+    modoSilencioso = 1;
     
-    if (dadoAtacante > dadoDefensor) {
-        // Atacante vence
-        printf("VITÓRIA DO ATACANTE!\n");
-        printf("Território '%s' foi conquistado por %s!\n", defensor->nome, atacante->cor);
-        
-        // Transferir controle do território
-        strcpy(defensor->cor, atacante->cor);
-        
-        // Transferir metade das tropas do atacante para o defensor
-        int tropasTransferidas = atacante->tropas / 2;
-        defensor->tropas = tropasTransferidas;
-        atacante->tropas -= tropasTransferidas;
-        
-        printf("Tropas transferidas: %d\n", tropasTransferidas);
-        printf("Tropas restantes do atacante: %d\n", atacante->tropas);
+    for (int rodada = 0; confere && rodada < cenario->maxRodadas; rodada++) {
+        // Uma cor por rodada: as demais só são afetadas à distância
+        int cor = rodada % totalCores;
+        int total = posseVazia(cor) ? 0 : planejarAtaques(cor, cenario->ataquesPorRodada, ataques);
+        int houveAtaque = 0;
+        for (int a = 0; a < total; a++) {
+            if (validarAtaque(&mapa[ataques[a].atacante], &mapa[ataques[a].defensor])) {
+                atacar(&mapa[ataques[a].atacante], &mapa[ataques[a].defensor]);
+                houveAtaque = 1;
+            }
+        }
+        if (!houveAtaque) {
+            continue;  // Esta cor não consegue atacar
+        }
         
-    } else {
-        // Defensor vence
-        printf("VITÓRIA DO DEFENSOR!\n");
-        printf("Território '%s' resistiu ao ataque!\n", defensor->nome);
+        int refeitas = atualizarViabilidade();
+        memcpy(incremental, analiseViabilidade.resultado, sizeof(incremental));
+        analiseViabilidade.calculadas = 0;
+        atualizarViabilidade();
         
-        // Atacante perde uma tropa
-        if (atacante->tropas > 1) {
-            atacante->tropas--;
-            printf("O atacante perdeu 1 tropa. Tropas restantes: %d\n", atacante->tropas);
-        } else {
-            printf("O atacante não pode perder mais tropas (mínimo: 1).\n");
+        for (int c = 0; c < totalCores && confere; c++) {
+            for (int m = 0; m < TOTAL_MISSOES && !posseVazia(c); m++) {
+                const struct ViabilidadeMissao* antes = &incremental[c][m];
+                const struct ViabilidadeMissao* refeita = &analiseViabilidade.resultado[c][m];
+                if (antes->limiteInferior != refeita->limiteInferior ||
+                    antes->ataquesEsperados != refeita->ataquesEsperados) {
+                    printf("Erro: Cenário '%s', rodada %d: viabilidade de %s em \"%s\" ficou em "
+                           "%.1f; refeita do zero dá %.1f (%d cores recalculadas)!\n",
+                           cenario->nome, rodada + 1, coresRegistradas[c], missoesPredefinidas[m],
+                           antes->ataquesEsperados, refeita->ataquesEsperados, refeitas);
+                    confere = 0;
+                    break;
+                }
+            }
         }
     }
     
-    printf("=================================================\n");
+    geradorAtaques = geradorAnterior;
+    modoSilencioso = silencioAnterior;
+    liberarAnaliseViabilidade();
+    liberarIndiceAlvos();
+    free(ataques);
+    liberarVetorGrande(mapa);
+    return confere;
 }
 
 /*
- * Função para validar se um ataque é permitido
+ * Função para executar um cenário da bateria de regressão
  * 
  * Parâmetros:
- * - atacante: ponteiro para o território atacante
- * - defensor: ponteiro para o território defensor
+ * - cenario: cenário a jogar
+ * - repeticoes: partidas jogadas a partir do mesmo mapa inicial
+ * - medido: ponteiro que recebe vazão e latência
  * 
  * Retorna:
- * - 1 se o ataque é válido
- * - 0 se o ataque não é permitido
+ * - 1 se todas as partidas terminaram no estado de referência
+ * - 0 caso contrário (ou em caso de erro)
  */
-int validarAtaque(struct Territorio* atacante, struct Territorio* defensor) {
-    // Verificar se são territórios diferentes
-    if (atacante == defensor) {
-        printf("Erro: Um território não pode atacar a si mesmo!\n");
+int executarCenario(const struct CenarioRegressao* cenario, int repeticoes,
+                    struct DesempenhoCenario* medido) {
+    // Cores registradas do zero: identificadores e sorteio de missões não
+    // dependem dos cenários anteriores
+    liberarIndiceAlvos();
+    totalCores = 0;
+    
+    int tamanho = 0;
+    struct Territorio* original = prepararCenario(cenario, &tamanho);
+    if (original == NULL) {
         return 0;
     }
-    
-    // Verificar se são da mesma cor (aliados)
-    if (strcmp(atacante->cor, defensor->cor) == 0) {
-        printf("Erro: Territórios aliados (%s) não podem se atacar!\n", atacante->cor);
+    struct Territorio* mapa = alocarTerritorios(tamanho);
+    double* segundos = (double*)malloc(repeticoes * sizeof(double));
+    if (mapa == NULL || segundos == NULL) {
+        free(segundos);
+        liberarVetorGrande(mapa);
+        liberarVetorGrande(original);
+        liberarAdjacencia();
         return 0;
     }
     
-    // Verificar se o atacante tem tropas suficientes
-    if (atacante->tropas < 2) {
-        printf("Erro: O atacante precisa ter pelo menos 2 tropas para atacar!\n");
-        return 0;
+    int modoAnterior = modoCombate;
+    int loteAnterior = threadsLote;
+    int ataquesAnteriores = ataquesPorRodada;
+    int missaoAnterior = missaoPartidas;
+    modoCombate = cenario->combate;
+    missaoPartidas = cenario->missao;
+    threadsLote = cenario->lote;
+    ataquesPorRodada = cenario->ataquesPorRodada;
+    
+    int confere = 1;
+    if (cenario->conferencia == CONFERIR_LOTE_SERIAL) {
+        confere = conferirLoteSerial(original, tamanho, cenario);
+    } else if (cenario->conferencia == CONFERIR_VIABILIDADE) {
+        confere = conferirViabilidade(original, tamanho, cenario);
+    }
+    uint64_t espalhamento = 0;
+    long long ataques = 0;
+    for (int r = 0; r < repeticoes && confere; r++) {
+        // Partidas curtas são repetidas até somar TEMPO_MINIMO_REGRESSAO
+        double total = 0.0;
+        int partidas = 0;
+        
+        while (confere && (partidas == 0 || total < TEMPO_MINIMO_REGRESSAO)) {
+            struct GeradorDados gerador;
+            struct ResultadoPartida resultado;
+            
+            memcpy(mapa, original, tamanho * sizeof(struct Territorio));
+            if (!construirIndiceAlvos(mapa, tamanho)) {
+                printf("Erro: Memória insuficiente para o índice do cenário '%s'!\n", cenario->nome);
+                confere = 0;
+                break;
+            }
+            iniciarGerador(&gerador, cenario->semente);
+            
+            double inicio = relogioSegundos();
+            simularPartida(mapa, tamanho, &gerador, cenario->maxRodadas, &resultado);
+            total += relogioSegundos() - inicio;
+            partidas++;
+            
+            // O índice tem de chegar ao fim da partida igual a um recém-construído
+            if (!verificarIndiceAlvos()) {
+                printf("Erro: Índice de alvos inconsistente no fim do cenário '%s'!\n", cenario->nome);
+                confere = 0;
+                break;
+            }
+            espalhamento = espalharEstadoFinal(mapa, tamanho, &resultado);
+            ataques = resultado.ataques;
+            if (espalhamento != cenario->espalhamentoEsperado) {
+                printf("Erro: Cenário '%s' terminou em 0x%016llxULL; a referência é 0x%016llxULL!\n",
+                       cenario->nome, (unsigned long long)espalhamento,
+                       (unsigned long long)cenario->espalhamentoEsperado);
+                confere = 0;
+            }
+        }
+        segundos[r] = partidas > 0 ? total / partidas : 0.0;
     }
     
-    return 1; // Ataque válido
+    modoCombate = modoAnterior;
+    threadsLote = loteAnterior;
+    ataquesPorRodada = ataquesAnteriores;
+    missaoPartidas = missaoAnterior;
+    
+    if (confere) {
+        // Ordenação por inserção: poucas repetições
+        for (int k = 1; k < repeticoes; k++) {
+            double valor = segundos[k];
+            int j = k;
+            while (j > 0 && segundos[j - 1] > valor) {
+                segundos[j] = segundos[j - 1];
+                j--;
+            }
+            segundos[j] = valor;
+        }
+        double melhor = segundos[0];
+        
+        snprintf(medido->nome, sizeof(medido->nome), "%s", cenario->nome);
+        medido->ataquesPorSegundo = melhor > 0.0 ? ataques / melhor : 0.0;
+        medido->melhorMs = melhor * 1e3;
+        medido->medianaMs = segundos[repeticoes / 2] * 1e3;
+        medido->piorMs = segundos[repeticoes - 1] * 1e3;
+        medido->ataques = ataques;
+    }
+    
+    free(segundos);
+    liberarIndiceAlvos();
+    liberarVetorGrande(mapa);
+    liberarVetorGrande(original);
+    liberarAdjacencia();
+    return confere;
 }
 
 /*
- * Função para gerenciar o loop de batalhas com verificação de missão
+ * Função para executar a bateria de regressão
  * 
  * Parâmetros:
- * - mapa: ponteiro para o vetor de territórios
- * - quantidade: número total de territórios
+ * - repeticoes: partidas por cenário
+ * 
+ * Retorna:
+ * - 1 se todos os cenários conferem e nenhum ficou mais lento que a base
+ * - 0 caso contrário
  */
-void gerenciarBatalhas(struct Territorio* mapa, int quantidade) {
-    int continuar = 1;
-    int indiceAtacante, indiceDefensor;
-    char opcao;
+int executarRegressao(int repeticoes) {
+    struct DesempenhoCenario medidos[TOTAL_CENARIOS];
+    struct DesempenhoCenario base[TOTAL_CENARIOS];
+    int totalBase = 0;
+    int conferidos = 0;
+    
+    if (caminhoBaseDesempenho != NULL && !gravarBaseDesempenho) {
+        totalBase = lerBaseDesempenho(caminhoBaseDesempenho, base);
+        if (totalBase == 0) {
+            printf("Aviso: base de desempenho '%s' ausente ou vazia; só os resultados serão conferidos.\n",
+                   caminhoBaseDesempenho);
+        }
+    }
     
     printf("\n=================================================\n");
-    printf("           MODO DE BATALHA ATIVADO\n");
+    printf("   BATERIA DE REGRESSÃO: %d cenários, %d partidas cada\n", TOTAL_CENARIOS, repeticoes);
     printf("=================================================\n");
     
-    while (continuar) {
-        // Exibir mapa atual
-        exibirTerritorios(mapa, quantidade);
-        
-        // Verificar se a missão foi cumprida (verificação silenciosa)
-        if (verificarMissao(missaoJogador, mapa, quantidade)) {
-            printf("\n🎉 PARABÉNS! MISSÃO CUMPRIDA! 🎉\n");
-            printf("=================================================\n");
-            printf("           VITÓRIA!\n");
-            printf("=================================================\n");
-            printf("Você completou sua missão: %s\n", missaoJogador);
-            printf("=================================================\n");
-            break;
-        }
-        
-        // Selecionar território atacante
-        printf("\n--- SELEÇÃO DO ATACANTE ---\n");
-        indiceAtacante = selecionarTerritorio(mapa, quantidade, "atacar");
-        if (indiceAtacante == -1) continue;
-        
-        // Selecionar território defensor
-        printf("\n--- SELEÇÃO DO DEFENSOR ---\n");
-        indiceDefensor = selecionarTerritorio(mapa, quantidade, "defender");
-        if (indiceDefensor == -1) continue;
-        
-        // Validar ataque
-        if (!validarAtaque(&mapa[indiceAtacante], &mapa[indiceDefensor])) {
+    for (int k = 0; k < TOTAL_CENARIOS; k++) {
+        conferidos += executarCenario(&cenariosRegressao[k], repeticoes, &medidos[conferidos]);
+    }
+    
+    printf("\n%-18s %6s %8s %12s %11s %11s %11s  %s\n",
+           "Cenário", "Estado", "Ataques", "Ataques/s", "Melhor ms", "Mediana ms", "Pior ms", "Base");
+    int falhas = TOTAL_CENARIOS - conferidos;
+    int m = 0;
+    for (int k = 0; k < TOTAL_CENARIOS; k++) {
+        if (m >= conferidos || strcmp(medidos[m].nome, cenariosRegressao[k].nome) != 0) {
+            printf("%-18s %6s\n", cenariosRegressao[k].nome, "FALHA");
             continue;
         }
         
-        // Executar ataque
-        atacar(&mapa[indiceAtacante], &mapa[indiceDefensor]);
-        
-        // Verificar novamente se a missão foi cumprida após o ataque
-        if (verificarMissao(missaoJogador, mapa, quantidade)) {
-            printf("\n🎉 PARABÉNS! MISSÃO CUMPRIDA! 🎉\n");
-            printf("=================================================\n");
-            printf("           VITÓRIA!\n");
-            printf("=================================================\n");
-            printf("Você completou sua missão: %s\n", missaoJogador);
-            printf("=================================================\n");
-            break;
+        const struct DesempenhoCenario* atual = &medidos[m++];
+        const struct DesempenhoCenario* referencia = NULL;
+        for (int b = 0; b < totalBase; b++) {
+            if (strcmp(base[b].nome, atual->nome) == 0) {
+                referencia = &base[b];
+            }
         }
         
-        // Perguntar se deseja continuar
-        printf("\nDeseja realizar outro ataque? (s/n): ");
-        scanf(" %c", &opcao);
+        printf("%-18s %6s %8lld %12.0f %11.3f %11.3f %11.3f  ", atual->nome, "ok", atual->ataques,
+               atual->ataquesPorSegundo, atual->melhorMs, atual->medianaMs, atual->piorMs);
+        if (referencia == NULL) {
+            printf("-\n");
+            continue;
+        }
         
-        if (opcao == 'n' || opcao == 'N') {
-            continuar = 0;
+        // A melhor partida é a medida menos sujeita ao ruído da máquina
+        double piora = 100.0 * (atual->melhorMs / referencia->melhorMs - 1.0);
+        if (piora > toleranciaRegressao) {
+            printf("LENTO (+%.1f%%, base %.3f ms)\n", piora, referencia->melhorMs);
+            falhas++;
+        } else {
+            printf("%+.1f%%\n", piora);
         }
     }
+    printf("=================================================\n");
+    
+    if (falhas > 0) {
+        printf("Regressão: %d de %d cenários falharam (tolerância de desempenho: %.1f%%).\n",
+               falhas, TOTAL_CENARIOS, toleranciaRegressao);
+        return 0;
+    }
     
-    printf("\nModo de batalha encerrado.\n");
+    printf("Regressão: todos os %d cenários conferem.\n", TOTAL_CENARIOS);
+    if (caminhoBaseDesempenho != NULL && gravarBaseDesempenho) {
+        return gravarBase(caminhoBaseDesempenho, medidos, conferidos);
+    }
+    return 1;
 }
 
 /*
- * Função para liberar a memória alocada dinamicamente
+ * Função para exibir as opções de linha de comando
+ */
+void exibirUso(const char* programa) {
+    printf("Uso: %s [opções]\n", programa);
+    printf("  --combate=unico|classico   regra de combate (padrão: unico)\n");
+    printf("  --stats[=texto|json]       relatório de instrumentação ao sair\n");
+    printf("  --eventos=ARQUIVO          grava cada batalha em ARQUIVO (- = saída padrão;\n");
+    printf("                             o jogo passa a escrever na saída de erro)\n");
+    printf("  --eventos-binarios         eventos em registros binários em vez de NDJSON\n");
+    printf("  --exibicao-assincrona      exibe o mapa em uma thread própria\n");
+    printf("  --semente=N                semente das partidas automáticas\n");
+    printf("  --lote=N                   aplica cada turno automático em lote com N threads\n");
+    printf("  --ataques-por-rodada=K     ataques por jogador automático em cada rodada\n");
+    printf("  --mapa=ARQUIVO             joga no mapa salvo em ARQUIVO em vez de cadastrar\n");
+    printf("  --gerar-mapa=ARQUIVO       gera um mapa sintético em ARQUIVO e sai; aceita:\n");
+    printf("      --territorios=N        número de territórios (obrigatório)\n");
+    printf("      --cores=C              número de cores (padrão: 4)\n");
+    printf("      --regioes=R            número aproximado de regiões (padrão: N / 100)\n");
+    printf("      --cores-por=uniforme|regiao  distribuição das cores (padrão: regiao)\n");
+    printf("      --tropas=uniforme|exponencial  distribuição das tropas (padrão: uniforme)\n");
+    printf("      --tropas-max=M         máximo de tropas por território (padrão: 10)\n");
+    printf("      --threads=T            threads de geração (padrão: processadores)\n");
+    printf("      (--semente=N também define o mapa gerado)\n");
+    printf("  --paginas-grandes[=transparentes|explicitas]  vetores do mapa em páginas de 2 MiB\n");
+    printf("  --medir-varredura[=R]      com --mapa, compara os modos de alocação e sai\n");
+    printf("  --fazenda=N                com --mapa, joga partidas automáticas em N processos e sai\n");
+    printf("  --partidas=G               partidas jogadas pela fazenda (padrão: 1000)\n");
+    printf("  --viabilidade              com --mapa, estima os ataques que faltam para cada missão e sai\n");
+    printf("  --regressao[=R]            joga os cenários de referência R vezes cada, confere e sai\n");
+    printf("      --base-desempenho=ARQUIVO  compara a melhor partida de cada cenário com ARQUIVO\n");
+    printf("      --gravar-base          grava a medição atual em ARQUIVO em vez de comparar\n");
+    printf("      --tolerancia=P         piora aceita em %% (padrão: 25)\n");
+    printf("  --script=ARQUIVO           lê respostas e comandos de ARQUIVO em vez do teclado\n");
+}
+
+/*
+ * Função para interpretar as opções de linha de comando
  * 
- * Parâmetros:
- * - mapa: ponteiro para o vetor de territórios a ser liberado
+ * Opções:
+ * - --combate=unico: um dado para cada lado (padrão)
+ * - --combate=classico: até 3 dados contra 3, perdas por par
+ * - --stats[=texto|json]: relatório de instrumentação ao sair
+ * - --eventos=ARQUIVO: grava cada batalha em ARQUIVO ("-" = saída padrão)
+ * - --eventos-binarios: usa registros binários em vez de NDJSON
+ * - --exibicao-assincrona: exibe o mapa em uma thread própria
+ * - --semente=N: semente das partidas automáticas
+ * - --lote=N: partidas automáticas aplicam cada turno em lote com N threads
+ * - --ataques-por-rodada=K: ataques planejados por jogador automático
+ * - --mapa=ARQUIVO: carrega o mapa de ARQUIVO em vez de cadastrar
+ * - --gerar-mapa=ARQUIVO e parâmetros: gera um mapa sintético (ver exibirUso)
+ * - --paginas-grandes[=transparentes|explicitas]: páginas de 2 MiB e
+ *   primeiro toque paralelo nos vetores do mapa
+ * - --medir-varredura[=R]: mede as varreduras de missão em cada modo
+ * - --fazenda=N: joga partidas automáticas em N processos
+ * - --partidas=G: partidas jogadas pela fazenda
+ * - --script=ARQUIVO: lê toda a entrada do jogo de ARQUIVO
+ * 
+ * Retorna:
+ * - 1 se todas as opções são válidas
+ * - 0 caso contrário (a mensagem de erro já foi exibida)
  */
-void liberarMemoria(struct Territorio* mapa) {
-    if (mapa != NULL) {
-        free(mapa);
-        printf("\nMemória dos territórios liberada com sucesso.\n");
+int interpretarArgumentos(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--combate=unico") == 0) {
+            modoCombate = COMBATE_DADO_UNICO;
+        } else if (strcmp(argv[i], "--combate=classico") == 0) {
+            modoCombate = COMBATE_CLASSICO;
+        } else if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=texto") == 0) {
+            formatoRelatorio = 1;
+        } else if (strcmp(argv[i], "--stats=json") == 0) {
+            formatoRelatorio = 2;
+        } else if (strncmp(argv[i], "--eventos=", 10) == 0 && argv[i][10] != '\0') {
+            caminhoEventos = argv[i] + 10;
+        } else if (strcmp(argv[i], "--eventos-binarios") == 0) {
+            eventosBinarios = 1;
+        } else if (strcmp(argv[i], "--exibicao-assincrona") == 0) {
+            usarExibicaoAssincrona = 1;
+        } else if (strncmp(argv[i], "--semente=", 10) == 0) {
+            sementePartida = strtoull(argv[i] + 10, NULL, 10);
+        } else if (strncmp(argv[i], "--lote=", 7) == 0 && atoi(argv[i] + 7) > 0) {
+            threadsLote = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--ataques-por-rodada=", 21) == 0 && atoi(argv[i] + 21) > 0) {
+            ataquesPorRodada = atoi(argv[i] + 21);
+        } else if (strncmp(argv[i], "--mapa=", 7) == 0 && argv[i][7] != '\0') {
+            caminhoMapa = argv[i] + 7;
+        } else if (strncmp(argv[i], "--gerar-mapa=", 13) == 0 && argv[i][13] != '\0') {
+            caminhoMapaGerado = argv[i] + 13;
+        } else if (strncmp(argv[i], "--territorios=", 14) == 0 && atoi(argv[i] + 14) > 0) {
+            parametrosGerador.quantidade = atoi(argv[i] + 14);
+        } else if (strncmp(argv[i], "--cores=", 8) == 0 && atoi(argv[i] + 8) > 0 &&
+                   atoi(argv[i] + 8) <= MAX_CORES) {
+            parametrosGerador.cores = atoi(argv[i] + 8);
+        } else if (strncmp(argv[i], "--regioes=", 10) == 0 && atoi(argv[i] + 10) > 0) {
+            parametrosGerador.regioes = atoi(argv[i] + 10);
+        } else if (strcmp(argv[i], "--cores-por=uniforme") == 0) {
+            parametrosGerador.distribuicaoCores = CORES_UNIFORMES;
+        } else if (strcmp(argv[i], "--cores-por=regiao") == 0) {
+            parametrosGerador.distribuicaoCores = CORES_POR_REGIAO;
+        } else if (strcmp(argv[i], "--tropas=uniforme") == 0) {
+            parametrosGerador.distribuicaoTropas = TROPAS_UNIFORMES;
+        } else if (strcmp(argv[i], "--tropas=exponencial") == 0) {
+            parametrosGerador.distribuicaoTropas = TROPAS_EXPONENCIAIS;
+        } else if (strncmp(argv[i], "--tropas-max=", 13) == 0 && atoi(argv[i] + 13) > 0) {
+            parametrosGerador.tropasMaximas = atoi(argv[i] + 13);
+        } else if (strncmp(argv[i], "--threads=", 10) == 0 && atoi(argv[i] + 10) > 0) {
+            parametrosGerador.numThreads = atoi(argv[i] + 10);
+        } else if (strcmp(argv[i], "--paginas-grandes") == 0 ||
+                   strcmp(argv[i], "--paginas-grandes=transparentes") == 0) {
+            modoAlocacao = ALOCACAO_TRANSPARENTE;
+        } else if (strcmp(argv[i], "--paginas-grandes=explicitas") == 0) {
+            modoAlocacao = ALOCACAO_EXPLICITA;
+        } else if (strcmp(argv[i], "--medir-varredura") == 0) {
+            repeticoesVarredura = REPETICOES_VARREDURA;
+        } else if (strncmp(argv[i], "--medir-varredura=", 18) == 0 && atoi(argv[i] + 18) > 0) {
+            repeticoesVarredura = atoi(argv[i] + 18);
+        } else if (strncmp(argv[i], "--fazenda=", 10) == 0 && atoi(argv[i] + 10) > 0) {
+            processosFazenda = atoi(argv[i] + 10);
+        } else if (strncmp(argv[i], "--partidas=", 11) == 0 && atoi(argv[i] + 11) > 0) {
+            partidasFazenda = atoi(argv[i] + 11);
+        } else if (strcmp(argv[i], "--regressao") == 0) {
+            repeticoesRegressao = REPETICOES_REGRESSAO;
+        } else if (strncmp(argv[i], "--regressao=", 12) == 0 && atoi(argv[i] + 12) > 0) {
+            repeticoesRegressao = atoi(argv[i] + 12);
+        } else if (strncmp(argv[i], "--base-desempenho=", 18) == 0 && argv[i][18] != '\0') {
+            caminhoBaseDesempenho = argv[i] + 18;
+        } else if (strcmp(argv[i], "--gravar-base") == 0) {
+            gravarBaseDesempenho = 1;
+        } else if (strncmp(argv[i], "--tolerancia=", 13) == 0 && atof(argv[i] + 13) >= 0.0) {
+            toleranciaRegressao = atof(argv[i] + 13);
+        } else if (strcmp(argv[i], "--viabilidade") == 0) {
+            analisarViabilidade = 1;
+        } else if (strncmp(argv[i], "--script=", 9) == 0 && argv[i][9] != '\0') {
+            caminhoScript = argv[i] + 9;
+        } else {
+            printf("Erro: opção desconhecida '%s'.\n", argv[i]);
+            exibirUso(argv[0]);
+            return 0;
+        }
     }
     
-    if (missaoJogador != NULL) {
-        free(missaoJogador);
-        printf("Memória da missão liberada com sucesso.\n");
+    if (caminhoMapaGerado != NULL && parametrosGerador.quantidade == 0) {
+        printf("Erro: --gerar-mapa precisa de --territorios=N.\n");
+        return 0;
+    }
+    if (repeticoesVarredura > 0 && caminhoMapa == NULL) {
+        printf("Erro: --medir-varredura precisa de --mapa=ARQUIVO.\n");
+        return 0;
+    }
+    if (processosFazenda > 0 && caminhoMapa == NULL) {
+        printf("Erro: --fazenda precisa de --mapa=ARQUIVO.\n");
+        return 0;
+    }
+    if (analisarViabilidade && caminhoMapa == NULL) {
+        printf("Erro: --viabilidade precisa de --mapa=ARQUIVO.\n");
+        return 0;
+    }
+    if (gravarBaseDesempenho && caminhoBaseDesempenho == NULL) {
+        printf("Erro: --gravar-base precisa de --base-desempenho=ARQUIVO.\n");
+        return 0;
     }
+    return 1;
 }
 
 /*
@@ -463,14 +7018,92 @@ void liberarMemoria(struct Territorio* mapa) {
  * 5. Gerenciar o loop de batalhas com verificação de missão
  * 6. Liberar memória ao final
  */
-int main() {
+int main(int argc, char* argv[]) {
     // Inicialização da semente para números aleatórios
     srand(time(NULL));
+    sementePartida = (uint64_t)time(NULL);
     
     // Declaração de variáveis
     struct Territorio* mapa = NULL;
     int quantidade;
     char opcao;
+    char resposta[16];
+    
+    // Opções de linha de comando
+    if (!interpretarArgumentos(argc, argv)) {
+        return 1;
+    }
+    ativarRelatorioInstrumentacao();
+    
+    // Geração de mapa sintético: gera o arquivo e sai
+    if (caminhoMapaGerado != NULL) {
+        parametrosGerador.semente = sementePartida;
+        if (parametrosGerador.regioes == 0) {
+            parametrosGerador.regioes = parametrosGerador.quantidade / 100 > 0 ?
+                                        parametrosGerador.quantidade / 100 : 1;
+        }
+        if (parametrosGerador.numThreads == 0) {
+            parametrosGerador.numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        }
+        return gerarMapa(caminhoMapaGerado, &parametrosGerador) ? 0 : 1;
+    }
+    
+    // Bateria de regressão: joga os cenários de referência e sai
+    if (repeticoesRegressao > 0) {
+        return executarRegressao(repeticoesRegressao) ? 0 : 1;
+    }
+    
+    // Comparação dos modos de alocação: mede e sai
+    if (repeticoesVarredura > 0) {
+        mapa = carregarMapa(caminhoMapa, &quantidade);
+        if (mapa == NULL) {
+            return 1;
+        }
+        medirVarreduras(mapa, quantidade, repeticoesVarredura);
+        liberarMemoria(mapa);
+        return 0;
+    }
+    
+    // Fazenda de simulação: partidas automáticas em processos e sai
+    if (processosFazenda > 0) {
+        mapa = carregarMapa(caminhoMapa, &quantidade);
+        if (mapa == NULL || !construirIndiceAlvos(mapa, quantidade)) {
+            liberarMemoria(mapa);
+            return 1;
+        }
+        int completa = executarFazenda(mapa, quantidade, processosFazenda, partidasFazenda);
+        liberarMemoria(mapa);
+        return completa ? 0 : 1;
+    }
+    
+    // Viabilidade das missões: analisa o mapa e sai
+    if (analisarViabilidade) {
+        mapa = carregarMapa(caminhoMapa, &quantidade);
+        if (mapa == NULL || !construirIndiceAlvos(mapa, quantidade)) {
+            liberarMemoria(mapa);
+            return 1;
+        }
+        exibirViabilidade();
+        liberarMemoria(mapa);
+        return 0;
+    }
+    
+    // Fluxo de eventos de batalha, se pedido
+    if (caminhoEventos != NULL && !iniciarFluxoEventos(caminhoEventos, eventosBinarios)) {
+        return 1;
+    }
+    
+    // Entrada do jogo: script de comandos ou entrada padrão
+    if (caminhoScript != NULL) {
+        int script = open(caminhoScript, O_RDONLY);
+        if (script < 0) {
+            printf("Erro: Não foi possível abrir o script '%s'!\n", caminhoScript);
+            return 1;
+        }
+        iniciarLeitor(script);
+    } else {
+        iniciarLeitor(STDIN_FILENO);
+    }
     
     // Mensagem de boas-vindas
     printf("=================================================\n");
@@ -482,11 +7115,16 @@ int main() {
     printf("- Transferência de controle de territórios\n");
     printf("- Missões estratégicas individuais\n");
     printf("- Verificação automática de vitória\n");
+    printf("Regra de combate: %s\n",
+           modoCombate == COMBATE_CLASSICO ? "clássica (até 3 dados contra 3)" : "dado único");
     printf("=================================================\n");
     
     // Solicitar cor do jogador
     printf("\nDigite sua cor de exército: ");
-    scanf("%9s", corJogador);
+    if (!lerPalavra(corJogador, sizeof(corJogador))) {
+        printf("\nErro: Entrada encerrada antes da cor do exército!\n");
+        return 1;
+    }
     
     // Alocação dinâmica para a missão do jogador
     missaoJogador = (char*)malloc(100 * sizeof(char));
@@ -495,47 +7133,79 @@ int main() {
         return 1;
     }
     
-    // Atribuir missão estratégica aleatória
+    if (caminhoMapa != NULL) {
+        // Mapa salvo em arquivo (por exemplo, gerado com --gerar-mapa): sem
+        // perguntas, então já pode ser carregado para equilibrar a missão
+        mapa = carregarMapa(caminhoMapa, &quantidade);
+        if (mapa == NULL) {
+            liberarMemoria(NULL);
+            return 1;
+        }
+        construirIndiceAlvos(mapa, quantidade);
+    }
+    
+    // Atribuir missão estratégica (equilibrada quando o mapa já é conhecido)
     atribuirMissao(missaoJogador, missoesPredefinidas, TOTAL_MISSOES);
     
     // Exibir missão do jogador
     exibirMissao(missaoJogador);
     
-    // Solicitar número de territórios
-    printf("\nQuantos territórios deseja cadastrar? ");
-    scanf("%d", &quantidade);
-    
-    // Validação da entrada
-    if (quantidade <= 0) {
-        printf("Erro: Número de territórios deve ser maior que zero!\n");
-        liberarMemoria(NULL);
-        return 1;
-    }
-    
-    // Alocação dinâmica de memória
-    mapa = alocarTerritorios(quantidade);
-    if (mapa == NULL) {
-        liberarMemoria(NULL);
-        return 1; // Erro na alocação
+    if (caminhoMapa == NULL) {
+        // Solicitar número de territórios
+        printf("\nQuantos territórios deseja cadastrar? ");
+        if (lerInteiro(&quantidade) != 1) {
+            quantidade = 0;
+        }
+        
+        // Validação da entrada
+        if (quantidade <= 0) {
+            printf("Erro: Número de territórios deve ser maior que zero!\n");
+            liberarMemoria(NULL);
+            return 1;
+        }
+        
+        // Alocação dinâmica de memória
+        mapa = alocarTerritorios(quantidade);
+        if (mapa == NULL) {
+            liberarMemoria(NULL);
+            return 1; // Erro na alocação
+        }
+        
+        // Cadastro dos territórios
+        if (!cadastrarTerritorios(mapa, quantidade)) {
+            printf("\nErro: Entrada encerrada antes do fim do cadastro!\n");
+            liberarMemoria(mapa);
+            return 1;
+        }
+        
+        // Construção do índice de alvos (sugestões e atualizações incrementais)
+        construirIndiceAlvos(mapa, quantidade);
     }
     
-    // Cadastro dos territórios
-    cadastrarTerritorios(mapa, quantidade);
-    
     // Exibição inicial dos territórios
     exibirTerritorios(mapa, quantidade);
     
+    // Exibição assíncrona do mapa, se pedida
+    if (usarExibicaoAssincrona && !iniciarExibicaoAssincrona(quantidade)) {
+        printf("Aviso: exibição assíncrona indisponível; usando exibição direta.\n");
+    }
+    
     // Perguntar se deseja iniciar batalhas
-    printf("\nDeseja iniciar o modo de batalha? (s/n): ");
-    scanf(" %c", &opcao);
+    printf("\nDeseja iniciar o modo de batalha? (s/n, a = assistir partida automática): ");
+    lerPalavra(resposta, sizeof(resposta));
+    opcao = resposta[0];  // Vazia no fim da entrada
     
     if (opcao == 's' || opcao == 'S') {
         gerenciarBatalhas(mapa, quantidade);
+        encerrarExibicaoAssincrona();
         
         // Exibir estado final dos territórios
         printf("\n=== ESTADO FINAL DOS TERRITÓRIOS ===\n");
         exibirTerritorios(mapa, quantidade);
+    } else if (opcao == 'a' || opcao == 'A') {
+        assistirPartida(mapa, quantidade);
     }
+    encerrarExibicaoAssincrona();
     
     // Liberação da memória
     liberarMemoria(mapa);